@@ -27,6 +27,29 @@ namespace SimpleHTTP::Internal
 			return len;
 		}
 
+		int writev(const WriteSegment* segments, int count)
+		{
+			int total = 0;
+			for (int i = 0; i < count; i++) {
+				uint8_t apiflags = segments[i].copy ? TCP_WRITE_FLAG_COPY : 0;
+				//no PSH until the last segment
+				if (i + 1 < count) {
+					apiflags |= TCP_WRITE_FLAG_MORE;
+				}
+				auto err = tcp_write(pcb, (uint8_t*)segments[i].data, segments[i].len, apiflags);
+				if (err != ERR_OK) {
+					if (total == 0) {
+						return err;
+					}
+					break;
+				}
+				total += segments[i].len;
+			}
+			//what was queued stays queued if this fails, lwIP sends it from its timer
+			tcp_output(pcb);
+			return total;
+		}
+
 		inline err_t shutdown()
 		{
 			return tcp_close(pcb);
@@ -36,6 +59,10 @@ namespace SimpleHTTP::Internal
 			return tcp_sndbuf(pcb);
 		}
 
+		void recved(int len) {
+			tcp_recved(pcb, len);
+		}
+
 		inline bool getRemoteIPAddress(char* buf, int buflen) {
 #if LWIP_IPV6
 			switch (pcb->remote_ip.type) {
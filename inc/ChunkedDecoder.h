@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	/**
+	 * decodes a chunked transfer coding body a byte at a time so it can stop and resume anywhere,
+	 * including part way through a chunk size line. chunk extensions and trailers are skipped
+	 *
+	 * chunk data is copied straight to the output, the output may be the input (decoded in place) as it never gets ahead of it
+	 */
+	class ChunkedDecoder {
+	public:
+		ChunkedDecoder() { reset(); }
+
+		inline void reset() {
+			state = ChunkSize;
+			chunkRemaining = 0;
+			sizeDigits = 0;
+		}
+		/**
+		 * decodes from in until it's used up, out is full or the body ends
+		 * inSize/outSize in: bytes available, out: bytes consumed/written
+		 * OK once the last chunk and trailers have been consumed (anything after is left in in), MoreData or ERROR
+		 */
+		Result decode(const char* in, int* inSize, char* out, int* outSize);
+
+		inline bool isComplete() { return state == Done; }
+
+	private:
+		enum State : uint8_t {
+			ChunkSize,
+			ChunkExtension,
+			ChunkSizeLF,
+			ChunkData,
+			ChunkDataCR,
+			ChunkDataLF,
+			TrailerStart,
+			TrailerLine,
+			EndLF,
+			Done,
+			Failed
+		} state;
+		int chunkRemaining;
+		int sizeDigits;
+	};
+};
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "ServerConnection.h"
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	//a set of client connections and the loop that runs their requests
+	//Router owns the default pool, a ShardedServer has one per worker thread
+	class ConnectionPool {
+	public:
+		static const int maxConnections = SIMPLE_HTTP_MAX_CONNECTIONS;
+		static const uint32_t KeepaliveTimeout = 60 * 1000;
+	private:
+		ServerConnection clients[maxConnections];
+		int lastConnectionsInUse;
+		//maintained by ServerConnection as transports are attached and released
+		int connectionsInUse;
+		uint32_t keepaliveTimeout;
+		TimerWheel timers;
+
+		//intrusive FIFO of connections with a request (or more body data) to run
+		//pushed from the network callbacks, drained by process()
+		ServerConnection* readyHead;
+		ServerConnection* readyTail;
+
+		friend class ServerConnection;
+		void queueForProcessing(ServerConnection* conn);
+		void processConnection(ServerConnection* client);
+		/**
+		 * offers a streamed body handler the data it couldn't take when it arrived, true once the body is complete
+		 */
+		bool streamBody(ServerConnection* client);
+		static void keepaliveExpired(void* arg);
+	public:
+		ConnectionPool();
+		/**
+		 * runs the handlers for connections with a request ready and closes idle keep alive connections
+		 * only connections queued by the network callbacks are visited
+		 */
+		void process();
+
+		ServerConnection* getFreeConnection();
+		/**
+		 * idle time allowed between requests before a connection is closed
+		 * a handler can override this for its response with Response::setKeepaliveTimeout()
+		 */
+		inline void setKeepaliveTimeout(uint32_t ms) { keepaliveTimeout = ms; }
+		inline int getConnectionsInUseCount() { return connectionsInUse; }
+	};
+};
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stdint.h>
+#include <time.h>
+
+namespace SimpleHTTP {
+	/**
+	 * the Date response header, formatted at most once a second (by os_getUnixTime()) and reused until then
+	 * the cache is per thread so sharded servers don't share it
+	 */
+	class DateHeader {
+	public:
+		//"Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+		static const int Size = 37;
+		/**
+		 * the header line including its EOL, value is null while the clock isn't set (RFC 7231 7.1.1.2)
+		 */
+		static SimpleString get();
+		/**
+		 * writes the header line for seconds since the epoch to out (Size bytes)
+		 */
+		static void format(time_t seconds, char* out);
+
+	private:
+		//earlier than this the clock hasn't been set yet (2020-01-01)
+		static const time_t MinValidTime = 1577836800;
+	};
+};
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+namespace SimpleHTTP {
+	/**
+	 * finds the delimiters of a request line or header line in one pass
+	 * a block at a time using SSE2 or NEON when the target has them, other targets (e.g. the esp32) use a byte loop
+	 */
+	class DelimiterScanner {
+	public:
+		//where the delimiters are in one line, each is null if the line doesn't have one
+		struct Line {
+			const char* firstSpace;
+			const char* lastSpace;
+			//the first :
+			const char* colon;
+			//the \n ending the line (a \r before it is left to the caller), null if the line isn't complete
+			const char* eol;
+		};
+		/**
+		 * scans [begin,end) up to the first \n, only delimiters before it are recorded
+		 */
+		static void scanLine(const char* begin, const char* end, Line* line);
+		/**
+		 * scanLine() with the byte loop only, i.e. to check the vector version against
+		 */
+		static void scanLineBytes(const char* begin, const char* end, Line* line);
+
+	private:
+		static void scanBytes(const char* ptr, const char* end, Line* line);
+	};
+};
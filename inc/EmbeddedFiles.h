@@ -20,6 +20,7 @@
 #pragma once
 #include <map>
 #include <string>
+#include <string_view>
 #include "Request.h"
 #include "Response.h"
 
@@ -51,7 +52,7 @@ namespace SimpleHTTP
     class EmbeddedFilesHandler
     {
     private:
-        static map<string, EmbeddedFile *> fileMap;
+        static map<string, EmbeddedFile *, std::less<>> fileMap;
         static EmbeddedFileType* fileTypes;
 
     public:
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "ConnectionPool.h"
+#include "WebSocketManager.h"
+#include <stddef.h>
+
+namespace SimpleHTTP {
+	/**
+	 * static RAM taken by the pools for the current config, on the target this is built for
+	 * request data beyond SIMPLE_HTTP_REQUEST_ARENA_SIZE, bodies and queued sends are allocated on the heap as needed and are not included
+	 *
+	 * i.e. static_assert(SimpleHTTP::Footprint::total <= 48 * 1024, "http server too large");
+	 * SecureServer adds SecureServer::footprint when used
+	 */
+	struct Footprint {
+		static constexpr size_t connection = sizeof(ServerConnection);
+		//part of connection, the headers, path and pipelined bytes a request used to allocate on the heap
+		//the default fits a typical ~400 byte browser request (header map included) without touching the heap,
+		//lower SIMPLE_HTTP_REQUEST_ARENA_SIZE to trade RAM for heap allocations on larger requests
+		static constexpr size_t requestArena = SIMPLE_HTTP_REQUEST_ARENA_SIZE;
+		static constexpr size_t requestArenas = requestArena * SIMPLE_HTTP_MAX_CONNECTIONS;
+		//one per pool, the default pool is always present
+		static constexpr size_t connectionPool = sizeof(ConnectionPool);
+		static constexpr size_t websocket = sizeof(Websocket);
+		static constexpr size_t websockets = websocket * SIMPLE_HTTP_MAX_WEBSOCKETS;
+
+		static constexpr size_t total = connectionPool + websockets;
+	};
+};
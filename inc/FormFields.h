@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	/**
+	 * name=value&name=value fields of a query string or an application/x-www-form-urlencoded body
+	 *
+	 * the names and values are views in to the data passed to parse(), nothing is copied.
+	 * %xx and + are decoded in place the first time a name or value is looked at so the data
+	 * must stay writable and in place until the fields are no longer used
+	 */
+	class FormFields {
+	public:
+		static const int MaxFields = SIMPLE_HTTP_MAX_FORM_FIELDS;
+
+		FormFields() : data(nullptr), count(0) {}
+
+		/**
+		 * splits data in to fields without decoding them, fields after MaxFields are ignored
+		 */
+		void parse(char* data, int size);
+		/**
+		 * returns the decoded value of the first field with the (decoded) name, value is null if not found
+		 */
+		SimpleString get(const char* name);
+
+		inline int getCount() { return count; }
+		SimpleString getName(int index);
+		SimpleString getValue(int index);
+
+		/**
+		 * decodes %xx and + in place and returns the new size, invalid escapes are left as they are
+		 */
+		static int decode(char* data, int size);
+
+	private:
+		struct Field {
+			uint16_t nameOffset;
+			uint16_t nameLength;
+			uint16_t valueOffset;
+			uint16_t valueLength;
+			bool nameDecoded;
+			bool valueDecoded;
+		};
+		char* data;
+		Field fields[MaxFields];
+		int count;
+	};
+};
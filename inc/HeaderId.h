@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stdint.h>
+#include <array>
+
+namespace SimpleHTTP {
+	//well known request headers, recognised while parsing so they can be read without a name lookup
+	enum class HeaderId : uint8_t {
+		Host = 0,
+		Connection,
+		ContentLength,
+		ContentType,
+		TransferEncoding,
+		Accept,
+		AcceptEncoding,
+		AcceptLanguage,
+		Authorization,
+		CacheControl,
+		Cookie,
+		Expect,
+		IfModifiedSince,
+		IfNoneMatch,
+		Origin,
+		Range,
+		Referer,
+		UserAgent,
+		Upgrade,
+		SecWebSocketKey,
+		SecWebSocketVersion,
+		SecWebSocketProtocol,
+		SecWebSocketExtensions,
+		Count,
+		Unknown = Count
+	};
+
+	/**
+	 * maps a header name to its HeaderId with a perfect hash built at compile time
+	 */
+	class HeaderIds {
+	private:
+		static constexpr SimpleString names[] = {
+			SIMPLE_STR("host"),
+			SIMPLE_STR("connection"),
+			SIMPLE_STR("content-length"),
+			SIMPLE_STR("content-type"),
+			SIMPLE_STR("transfer-encoding"),
+			SIMPLE_STR("accept"),
+			SIMPLE_STR("accept-encoding"),
+			SIMPLE_STR("accept-language"),
+			SIMPLE_STR("authorization"),
+			SIMPLE_STR("cache-control"),
+			SIMPLE_STR("cookie"),
+			SIMPLE_STR("expect"),
+			SIMPLE_STR("if-modified-since"),
+			SIMPLE_STR("if-none-match"),
+			SIMPLE_STR("origin"),
+			SIMPLE_STR("range"),
+			SIMPLE_STR("referer"),
+			SIMPLE_STR("user-agent"),
+			SIMPLE_STR("upgrade"),
+			SIMPLE_STR("sec-websocket-key"),
+			SIMPLE_STR("sec-websocket-version"),
+			SIMPLE_STR("sec-websocket-protocol"),
+			SIMPLE_STR("sec-websocket-extensions"),
+		};
+		static constexpr int count = (int)HeaderId::Count;
+		static_assert(sizeof(names) / sizeof(names[0]) == count, "a name is needed for each HeaderId");
+
+		static const int slotCount = 128;
+
+		static constexpr uint8_t lower(char c) {
+			return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+		}
+		//only the length and three characters are hashed, the match is confirmed with a full compare
+		static constexpr uint32_t hash(const char* name, int length, uint32_t seed) {
+			uint32_t h = (seed + length) * 0x9e3779b9u;
+			h = (h ^ lower(name[0])) * 16777619u;
+			h = (h ^ lower(name[length / 2])) * 16777619u;
+			h = (h ^ lower(name[length - 1])) * 16777619u;
+			return (h ^ (h >> 16)) & (slotCount - 1);
+		}
+
+	public:
+		struct Table {
+			uint32_t seed;
+			std::array<uint8_t, slotCount> slots;
+			bool found;
+		};
+	private:
+
+		static constexpr Table build() {
+			for (uint32_t seed = 0; seed < 10000; seed++) {
+				Table t{ seed, {}, true };
+				for (auto& s : t.slots) {
+					s = (uint8_t)HeaderId::Unknown;
+				}
+				bool ok = true;
+				for (int i = 0; i < count && ok; i++) {
+					auto slot = hash(names[i].value, names[i].size, seed);
+					ok = t.slots[slot] == (uint8_t)HeaderId::Unknown;
+					t.slots[slot] = i;
+				}
+				if (ok) {
+					return t;
+				}
+			}
+			return { 0, {}, false };
+		}
+
+		friend struct HeaderIdTable;
+
+	public:
+		/**
+		 * case insensitive, returns HeaderId::Unknown for other headers
+		 */
+		static HeaderId find(const char* name, int length);
+
+		static inline SimpleString name(HeaderId id) {
+			return id < HeaderId::Count ? names[(int)id] : SimpleString{ nullptr, 0 };
+		}
+	};
+
+	//built once the HeaderIds class is complete
+	struct HeaderIdTable {
+		static constexpr HeaderIds::Table table = HeaderIds::build();
+		static_assert(table.found, "no perfect hash found for the header names");
+	};
+
+	inline HeaderId HeaderIds::find(const char* name, int length) {
+		if (length <= 0) {
+			return HeaderId::Unknown;
+		}
+		auto& table = HeaderIdTable::table;
+		auto id = table.slots[hash(name, length, table.seed)];
+		if (id == (uint8_t)HeaderId::Unknown || names[id].size != length) {
+			return HeaderId::Unknown;
+		}
+		for (int i = 0; i < length; i++) {
+			if (lower(name[i]) != names[id].value[i]) {
+				return HeaderId::Unknown;
+			}
+		}
+		return (HeaderId)id;
+	}
+};
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace SimpleHTTP::Internal
+{
+	/**
+	 * minimal io_uring wrapper using the raw syscalls so there is no dependency on liburing
+	 * only covers what SocketServer needs: one submission/completion ring and one provided buffer ring
+	 */
+	class IoUring
+	{
+	private:
+		int ringFd;
+
+		void* sqRingPtr;
+		size_t sqRingSize;
+		void* cqRingPtr;
+		size_t cqRingSize;
+		io_uring_sqe* sqes;
+		size_t sqesSize;
+
+		unsigned* sqHead;
+		unsigned* sqTail;
+		unsigned sqMask;
+		unsigned sqEntries;
+		//tail including sqes not yet made visible to the kernel
+		unsigned sqLocalTail;
+
+		unsigned* cqHead;
+		unsigned* cqTail;
+		unsigned cqMask;
+		io_uring_cqe* cqes;
+
+		io_uring_buf_ring* bufRing;
+		size_t bufRingSize;
+		unsigned bufRingMask;
+		uint16_t bufRingTail;
+		uint8_t* bufMemory;
+		size_t bufMemorySize;
+		int bufSize;
+
+	public:
+		IoUring();
+		~IoUring();
+		/**
+		 * returns 0 or a negative errno
+		 */
+		int init(unsigned entries);
+		void destroy();
+		/**
+		 * returns a zeroed sqe, submitting pending entries first if the queue is full
+		 */
+		io_uring_sqe* getSqe();
+		/**
+		 * submits queued sqes and waits for at least waitCount completions or timeoutMs
+		 */
+		int submitAndWait(unsigned waitCount, int timeoutMs);
+		/**
+		 * returns the next completion or null, call cqeSeen() once it has been handled
+		 */
+		io_uring_cqe* peekCqe();
+		void cqeSeen();
+		/**
+		 * registers count buffers of size bytes with the kernel for IOSQE_BUFFER_SELECT receives
+		 * count must be a power of 2, returns 0 or a negative errno
+		 */
+		int setupBufferRing(uint16_t groupId, unsigned count, int size);
+
+		inline uint8_t* getBuffer(uint16_t bufferId) {
+			return bufMemory + (size_t)bufferId * bufSize;
+		}
+		/**
+		 * gives a buffer back to the kernel once its data has been consumed
+		 */
+		void recycleBuffer(uint16_t bufferId);
+	};
+};
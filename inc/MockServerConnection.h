@@ -21,24 +21,51 @@
 #include "ServerConnection.h"
 #include <string>
 namespace SimpleHTTPTest {
+	//Transport that captures everything written into a string
+	class MockTransport : public SimpleHTTP::Internal::Transport {
+	public:
+		std::string* buffer;
+		//calls to write() or writev()
+		int writes = 0;
+		int availableSendBuffer = 0xffff;
+
+		int write(const void* dataptr, u16_t len, uint8_t apiflags) {
+			writes++;
+			buffer->append((char*)dataptr, len);
+			return len;
+		}
+
+		int writev(const WriteSegment* segments, int count) {
+			writes++;
+			int total = 0;
+			for (int i = 0; i < count; i++) {
+				buffer->append((const char*)segments[i].data, segments[i].len);
+				total += segments[i].len;
+			}
+			return total;
+		}
+
+		err_t shutdown() { return ERR_OK; }
+
+		int getAvailableSendBuffer() { return availableSendBuffer; }
+
+		bool getRemoteIPAddress(char* buf, int buflen) { return false; }
+	};
+
 	//Dummy Connection for Testing
 	class MockServerConnection: public SimpleHTTP::ServerConnection {
 
 	public:
 		std::string buffer;
 	private:
-		tcp_pcb mockSocket{ & buffer };
+		MockTransport mockTransport;
 	public:
-		
-		static inline int writeDataMock(tcp_pcb* pcb, const void* dataptr, u16_t len, uint8_t apiflags) {
-			auto buffer = (std::string*)pcb->arg;
-			buffer->append((char*)dataptr, len);
-			return len;
-		}
+		inline int getWriteCount() { return mockTransport.writes; }
+		inline void setAvailableSendBuffer(int size) { mockTransport.availableSendBuffer = size; }
 
 		MockServerConnection() {
-			
-			init(&mockSocket, writeDataMock);
+			mockTransport.buffer = &buffer;
+			init(nullptr, &mockTransport);
 		}
 
 
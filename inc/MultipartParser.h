@@ -0,0 +1,122 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	class Request;
+
+	/**
+	 * streaming multipart/form-data parser, body data is fed in as it's received and each part's headers
+	 * and data are passed on straight away. only the part headers and up to a boundary's length of data
+	 * (when a chunk ends part way through what may be a boundary) are ever copied
+	 *
+	 * feed() it from readBody() or use onBodyChunk with Request::setBodyHandler()
+	 */
+	class MultipartParser {
+	public:
+		/**
+		 * one header of a part i.e Content-Disposition, the values are only valid during the call
+		 */
+		typedef void (*PartHeaderHandler) (void* arg, SimpleString name, SimpleString value);
+		/**
+		 * part body data, called as many times as needed for each part
+		 */
+		typedef void (*PartDataHandler) (void* arg, const char* data, int size);
+		/**
+		 * all of the current part's data has been passed on
+		 */
+		typedef void (*PartEndHandler) (void* arg);
+
+		//RFC 2046 limit
+		static const int MaxBoundaryLength = 70;
+		//headers of a single part, larger ones fail the parse
+		static const int MaxPartHeadersSize = 512;
+
+	private:
+		enum State : uint8_t {
+			Preamble,
+			AfterBoundary,
+			PartHeaders,
+			PartBody,
+			Done,
+			Failed
+		} state;
+
+		//CRLF -- boundary
+		char delimiter[MaxBoundaryLength + 4];
+		int delimiterLength;
+		//Boyer-Moore-Horspool shift for each byte value
+		uint8_t skip[256];
+
+		//end of the previous chunk that may be the start of a delimiter
+		char carry[MaxBoundaryLength + 4];
+		int carryLength;
+
+		char partHeaders[MaxPartHeadersSize];
+		int partHeadersLength;
+		//bytes of "--" or CRLF seen after a boundary
+		char afterBoundary[2];
+		int afterBoundaryLength;
+
+		PartHeaderHandler headerHandler;
+		PartDataHandler dataHandler;
+		PartEndHandler endHandler;
+		void* handlerArg;
+
+		int find(const char* data, int size);
+		int delimiterPrefixAtEnd(const char* data, int size);
+		void emit(const char* data, int size);
+		void boundaryFound();
+		/**
+		 * each feed() step consumes some of data and returns the count or -1 on error
+		 */
+		int parseBody(const char* data, int size);
+		int parseAfterBoundary(const char* data, int size);
+		int parsePartHeaders(const char* data, int size);
+
+	public:
+		MultipartParser();
+		/**
+		 * start a new body, contentType is the Content-Type request header which holds the boundary
+		 * ERROR if it's not multipart or has no valid boundary
+		 */
+		Result begin(SimpleString contentType, PartHeaderHandler onHeader, PartDataHandler onData, PartEndHandler onEnd, void* arg);
+		/**
+		 * parse the next piece of the body
+		 * OK once the closing boundary has been seen (anything after it is ignored), MoreData if it hasn't or ERROR
+		 */
+		Result feed(const char* data, int size);
+
+		inline bool isComplete() { return state == Done; }
+		inline bool hasFailed() { return state == Failed; }
+
+		/**
+		 * Request::setBodyHandler() chunk handler, the handler arg must be the MultipartParser
+		 */
+		static int onBodyChunk(Request* request, const char* data, int size);
+		/**
+		 * returns the value of a parameter of a header value (quotes removed) i.e name or filename from
+		 * form-data; name="file"; filename="a.txt". value is null if not found
+		 */
+		static SimpleString getHeaderParam(SimpleString headerValue, const char* name);
+	};
+};
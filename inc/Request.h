@@ -19,6 +19,10 @@
  */
 #pragma once
 #include "common.h"
+#include "HeaderId.h"
+#include "RequestArena.h"
+#include "FormFields.h"
+#include "ChunkedDecoder.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -28,8 +32,25 @@ using std::vector;
 using std::map;
 
 namespace SimpleHTTP {
+	class Response;
+	class ConnectionPool;
+	class ServerConnection;
+
 	//HTTP/1.1 Request Parsing
 	class Request {
+		friend class ConnectionPool;
+		friend class ServerConnection;
+		friend class Response;
+	public:
+		/**
+		 * takes streamed body data, returns the count of bytes used (the rest is offered again later)
+		 * called from the network context, so the response must not be written here
+		 */
+		typedef int (*BodyChunkHandler) (Request* request, const char* data, int size);
+		/**
+		 * called in the same context as route handlers once the whole body has been taken, writes the response
+		 */
+		typedef void (*BodyEndHandler) (Request* request, Response* response);
 	private:
 		enum ParsingStage : int {
 			WaitingRequestLine,
@@ -37,27 +58,75 @@ namespace SimpleHTTP {
 			WaitingBody,
 			WaitingComplete
 		} parsingStage;
-		static const char SpaceChar = ' ';
 
 		Result lastResult;
+		//first reservation for requestBuffer, enough for the request line and headers of most requests
 		static const int requestBufferSize = 512;
 		static constexpr const char TransferEncodingHeaderName[] = "TRANSFER-ENCODING";
 		static constexpr const char ContentLengthHeaderName[] = "CONTENT-LENGTH";
 
-		vector<char> requestBuffer;
+		//request scoped data is allocated from here, declared first so it's constructed before the members using it
+		RequestArena arena;
+		ArenaBuffer requestBuffer;
 		int bufferReadPos;
 		int lastBodyOutputBytesWritten;
 
 		Result appendToBuffer(char* data, int size);
 
 		inline void resetBuffer() {
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+			//the headers are still referenced
+			requestBuffer.resize(headersSize);
+			bufferReadPos = headersSize;
+#else
 			requestBuffer.clear();
 			bufferReadPos = 0;
+#endif
 		}
 
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+		//header position in requestBuffer, offsets as the buffer may move as it grows
+		struct HeaderOffsets {
+			uint16_t nameOffset;
+			uint16_t nameLength;
+			uint16_t valueOffset;
+			uint16_t valueLength;
+		};
+		HeaderOffsets headerOffsets[SIMPLE_HTTP_MAX_HEADERS];
+		int headerCount;
+		//index in to headerOffsets for each well known header or -1
+		int8_t knownHeaders[(int)HeaderId::Count];
+		//bytes at the start of requestBuffer up to the end of the headers
+		int headersSize;
+#endif
+
 		bool bodyEncodingChunked;
+		ChunkedDecoder chunkedDecoder;
 		int bodyLength;
 		bool bodyReadInProgress;
+		//all of the body has been read, anything after it in requestBuffer is the next request
+		bool bodyComplete;
+		//bytes received for the next request before this one was finished with, see next()
+		//received bytes past SIMPLE_HTTP_MAX_PIPELINED_SIZE are held so the connection stops reading until next()
+		ArenaBuffer pipelined;
+		int pipelinedHeld;
+		Result keepPipelined(const char* data, int size);
+
+		BodyChunkHandler bodyChunkHandler;
+		BodyEndHandler bodyEndHandler;
+		void* bodyHandlerArg;
+		//body data goes to bodyChunkHandler as it arrives, bodyLength counts what is still to be received
+		bool bodyStreaming;
+		//bytes at the end of requestBuffer not yet taken by bodyChunkHandler and not given back to the receive window
+		int bodyHeld;
+		//the client sent Expect: 100-continue
+		bool expectContinue;
+		bool continueSent;
+
+		//the request target after the ?, decoded in place by queryFields
+		ArenaString query;
+		FormFields queryFields;
+		bool queryParsed;
 
 	public:
 		
@@ -80,19 +149,73 @@ namespace SimpleHTTP {
 			UnknownMethod
 		} method;
 
+		//longer header names are rejected
 		static const int MaxHeaderNameLength = 64;
 		static const int MaxHeaderValueLength = 255;
 
 		HTTPVersion version;
-		map<string, string> headers;
-		string path;
+#if !SIMPLE_HTTP_ZERO_COPY_HEADERS
+		//keyed by the upper case header name
+		ArenaStringMap headers;
+	private:
+		//values in headers for each well known header
+		const ArenaString* knownHeaders[(int)HeaderId::Count];
+	public:
+#endif
+		//request target without the query string
+		ArenaString path;
+
+		//a value captured from the path by a route such as /api/:id
+		struct PathParam {
+			//points in to the route tree
+			const char* name;
+			uint16_t offset;
+			uint16_t length;
+		};
+		static const int MaxPathParams = 4;
+		PathParam pathParams[MaxPathParams];
+		int pathParamCount;
 
+		/**
+		 * returns the value captured for the named route param (without the : or *)
+		 * the value points in to path and is not null terminated, value is null if not found
+		 */
+		SimpleString getPathParam(const char* name);
+		/**
+		 * fields of the query string, parsed the first time it's called and decoded as they're read
+		 */
+		FormFields& getQuery();
+		/**
+		 * parses an application/x-www-form-urlencoded body in place instead of readBody()
+		 * MoreData until all of it has been received, the fields are valid until the request is reset
+		 * ERROR if the body is chunked, larger than 64k or has already been read
+		 */
+		Result readForm(FormFields* form);
 
 		Request();
 
 		Result parse(char* data, int length);
+		/**
+		 * returns the value of the named header (case insensitive)
+		 * the value is not null terminated and is valid until the request is reset, value is null if not found
+		 */
+		SimpleString getHeader(const char* name);
+		/**
+		 * returns the value of a well known header without a name lookup, value is null if not received
+		 */
+		SimpleString header(HeaderId id);
+
+		/**
+		 * returns the name of the method i.e GET
+		 */
+		static SimpleString methodName(Method m);
 
 		void reset();
+		/**
+		 * resets for the next request on the connection then parses anything already received for it (pipelining)
+		 * returns as parse(), OK if there was nothing received yet
+		 */
+		Result next();
 
 		inline bool receivedAllHeaders() { return parsingStage == WaitingBody || parsingStage == WaitingComplete; };
 		/*
@@ -100,9 +223,13 @@ namespace SimpleHTTP {
 		* last time this method was called
 		*/
 		inline bool getAndClearForProcessing() {
+			if (bodyStreaming) {
+				//only data the handler couldn't take when it arrived and the end need the route handler context
+				return parsingStage == WaitingComplete || getBodyBuffered() > 0;
+			}
 			if (parsingStage == WaitingBody && hasMoreBodyDataSinceLastCheck) {
+				hasMoreBodyDataSinceLastCheck = false;
 				return true;
-				hasMoreBodyDataSinceLastCheck = true;
 			}
 			return parsingStage == WaitingComplete;
 		}
@@ -115,12 +242,30 @@ namespace SimpleHTTP {
 		Result readBody(char* dstBuffer, int* dstBufferSize);
 		/*
 		* reset the buffer position back to the point before the last call to readBody()
-		* OK or ERROR if net not be undone
+		* OK or ERROR if net not be undone (always for chunked bodies)
 		*/
 		Result unReadBody();
 
 		inline int getBodyLength() { return bodyLength; }
 		inline bool isBodyReadInProgress() { return bodyReadInProgress; }
+		/**
+		 * instead of readBody() have the body pushed to onChunk as it's received, onEnd is called once all of it is taken
+		 * data onChunk doesn't take is held back from the tcp receive window until it does
+		 * call from a route handler, false if the request has no body, it's chunked or readBody() was used
+		 */
+		bool setBodyHandler(BodyChunkHandler onChunk, BodyEndHandler onEnd, void* arg);
+		inline void* getBodyHandlerArg() { return bodyHandlerArg; }
+		/**
+		 * true if the client sent Expect: 100-continue and is waiting for Response::sendContinue() before sending the body
+		 * reading the body sends it automatically, writing an error status instead rejects the upload
+		 */
+		inline bool isExpectingContinue() { return expectContinue && !continueSent; }
+		/**
+		 * true if none of the body has been read, streamed or received
+		 */
+		inline bool hasUnreadBody() {
+			return parsingStage == WaitingBody && !bodyReadInProgress && !bodyComplete && (bodyLength != 0 || bodyEncodingChunked);
+		}
 
 	private:
 		static const constexpr struct SimpleString requestMethods[] = {
@@ -170,29 +315,59 @@ namespace SimpleHTTP {
 		bool hasMoreBodyDataSinceLastCheck;
 
 		HTTPVersion parseHTTPVersion(SimpleString str);
+
+		inline bool isBodyStreaming() { return bodyStreaming; }
+		inline int getBodyBuffered() { return requestBuffer.size() - bufferReadPos; }
+		inline int getBodyHeld() { return bodyHeld; }
+		/**
+		 * received bytes not to be given back to the receive window yet, body not taken by the handler and pipelined data over the limit
+		 * body received before the handler has chosen how to read it is held too, so the connection stops reading until it has
+		 */
+		inline int getRecvHeld() { return bodyHeld + pipelinedHeld + (hasUnreadBody() ? getBodyBuffered() : 0); }
+		/**
+		 * starts streaming once the route handler has called setBodyHandler()
+		 * call with the network locked, body received with the headers is offered straight away
+		 */
+		void beginBodyStream();
+		/**
+		 * offers onChunk the buffered body, returns the count of bytes taken
+		 */
+		int deliverBufferedBody();
+		/**
+		 * body data received while streaming
+		 */
+		Result streamBody(char* data, int length);
+		/**
+		 * offers data to onChunk, returns the count of bytes taken
+		 */
+		int offerBody(const char* data, int size);
+		/**
+		 * calls onEnd once the body has been streamed
+		 */
+		void endBody(Response* response);
 		/**
 		* parses a http header line i.e name:value\r\n
 		*/
 		HTTPHeader parseHeaderLine(SimpleString data, char** eolEndPosPtr);
 		/**
-		 * returns up to the first space
+		 * as parseHeaderLine() without copying the value
 		 */
-		string parsePath(const char* data, int size);
+		HTTPHeaderView parseHeaderLineView(SimpleString data, char** eolEndPosPtr);
 		/**
-		* returns a string up to the next instance of TOK CHAR
-		*/
-		SimpleString nextToken(SimpleString data, char tok);
+		 * parses a decimal Content-Length value, -1 if invalid
+		 */
+		static int parseContentLength(SimpleString value);
 		/**
-		 * returns the string up to \n. skipping  leading \r if any
-		**/
-		SimpleString nextEOL(SimpleString line, char** eolEndPosPtr);
+		 * returns up to the first space
+		 */
+		string parsePath(const char* data, int size);
 		/**
 		* returns true if the next line is blank
 		*/
 		int isEOL(SimpleString line);
 		/**
-		* returns true if the next token is 0\r\n\r\n
-		*/
-		bool isEndOfChunkedBodyMarker(SimpleString line);
+		 * readBody() for a chunked body
+		 */
+		Result readChunkedBody(char* dstBuffer, int* dstBufferSize);
 	};
 };
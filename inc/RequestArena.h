@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "common.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <map>
+#include <scoped_allocator>
+
+namespace SimpleHTTP {
+	/**
+	 * bump allocator for the data of one request, reset() frees everything at once
+	 * when full allocations fall back to the heap and are counted, see getHeapFallbackCount()
+	 *
+	 * not thread safe, each connection has its own
+	 */
+	class RequestArena {
+	public:
+		static const size_t Size = SIMPLE_HTTP_REQUEST_ARENA_SIZE;
+
+		RequestArena() : used(0), lastAllocation(0) {}
+		RequestArena(const RequestArena&) = delete;
+		RequestArena& operator=(const RequestArena&) = delete;
+
+		void* allocate(size_t size, size_t alignment);
+		/**
+		 * only the most recent arena allocation is given back, others are freed by reset()
+		 */
+		void deallocate(void* ptr, size_t size);
+		/**
+		 * anything still allocated from the arena must no longer be used
+		 */
+		inline void reset() { used = 0; lastAllocation = 0; }
+		/**
+		 * after reset(), moves size bytes that were in the arena before it to the start and keeps them allocated
+		 * returns where they are now, nothing already in the arena can be given back after this
+		 */
+		void* keep(const void* data, size_t size);
+		inline bool owns(const void* ptr) { return (const char*)ptr >= buffer && (const char*)ptr < buffer + sizeof(buffer); }
+
+		inline size_t getUsed() { return used; }
+		/**
+		 * allocations made on the heap because an arena was full, across all arenas
+		 */
+		static inline uint32_t getHeapFallbackCount() { return heapFallbacks; }
+
+	private:
+		alignas(max_align_t) char buffer[Size > 0 ? Size : 1];
+		size_t used;
+		size_t lastAllocation;
+
+		static std::atomic<uint32_t> heapFallbacks;
+
+	};
+
+	/**
+	 * std allocator over a RequestArena, a default constructed one uses the heap
+	 */
+	template<typename T>
+	struct ArenaAllocator {
+		typedef T value_type;
+
+		RequestArena* arena;
+
+		ArenaAllocator() : arena(nullptr) {}
+		ArenaAllocator(RequestArena* a) : arena(a) {}
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+		T* allocate(size_t n) {
+			if (arena == nullptr) {
+				return (T*)::operator new(n * sizeof(T));
+			}
+			return (T*)arena->allocate(n * sizeof(T), alignof(T));
+		}
+
+		void deallocate(T* ptr, size_t n) {
+			if (arena == nullptr) {
+				::operator delete(ptr);
+				return;
+			}
+			arena->deallocate(ptr, n * sizeof(T));
+		}
+
+		template<typename U>
+		inline bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+		template<typename U>
+		inline bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+	};
+
+	typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+	typedef std::vector<char, ArenaAllocator<char>> ArenaBuffer;
+	//the strings in each entry are allocated from the same arena as the map
+	typedef std::map<ArenaString, ArenaString, std::less<ArenaString>,
+		std::scoped_allocator_adaptor<ArenaAllocator<std::pair<const ArenaString, ArenaString>>>> ArenaStringMap;
+};
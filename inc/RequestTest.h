@@ -24,5 +24,10 @@ namespace SimpleHTTPTest {
 	class RequestTest : public SimpleHTTP::Request {
 	public:
 		bool testParseMethod(const char* strMethod, Method m);
+		using Request::beginBodyStream;
+		using Request::deliverBufferedBody;
+		using Request::getBodyHeld;
+		using Request::getRecvHeld;
+		using Request::endBody;
 	};
 }
\ No newline at end of file
@@ -25,8 +25,11 @@
 using std::string;
 
 namespace SimpleHTTP {
+	class ResponseProfile;
+
 	//HTTP/1.1 Response Generation
 	class Response {
+		friend class ResponseProfile;
 	public:
 		enum ConnectionMode {
 			ConnectionKeepAlive,
@@ -50,13 +53,20 @@ namespace SimpleHTTP {
 		int responseSizeTotal;
 
 		Result networkWrite(char* data, int length);
+		/**
+		 * Keep-Alive header with the timeout the connection will actually use
+		 */
+		void addKeepAliveHeader();
+		Result flushHeadersOnly();
 
 		static const constexpr struct SimpleString VersionString = SIMPLE_STR("HTTP/1.1 ");
-		static const constexpr struct SimpleString ChunckedTransferHeader = SIMPLE_STR("Transfer-Encoding: chunked");
-		static const constexpr struct SimpleString ConnectionKeepAliveHeader = SIMPLE_STR("Keep-Alive: timeout=15, max=1000");
-		static const constexpr struct SimpleString ConnectionCloseHeader = SIMPLE_STR("Connection: close");
-		static const constexpr struct SimpleString ConnectionUpgradeHeader = SIMPLE_STR("Connection: Upgrade");
+		//header lines appended on every response, EOL included so each is a single copy
+		static const constexpr struct SimpleString ChunckedTransferHeader = SIMPLE_STR("Transfer-Encoding: chunked\r\n");
+		static const constexpr struct SimpleString ConnectionKeepAliveHeader = SIMPLE_STR("Keep-Alive: timeout=");
+		static const constexpr struct SimpleString ConnectionCloseHeader = SIMPLE_STR("Connection: close\r\n");
+		static const constexpr struct SimpleString ConnectionUpgradeHeader = SIMPLE_STR("Connection: Upgrade\r\n");
 		static const constexpr struct SimpleString ContentLengthHeader = SIMPLE_STR("Content-Length: ");
+		static const constexpr struct SimpleString ContinueResponse = SIMPLE_STR("HTTP/1.1 100 Continue\r\n\r\n");
 
 		//max number of hex chars + EOL
 		static const int ChunkedTransferSizeHeaderSize = 20 + sizeof(EOL);
@@ -74,12 +84,19 @@ namespace SimpleHTTP {
 		   SIMPLE_STR("404 Not Found"),
 		   SIMPLE_STR("405 Method Not Allowed"),
 		   SIMPLE_STR("406 Not Acceptable"),
+		   SIMPLE_STR("411 Length Required"),
+		   SIMPLE_STR("413 Payload Too Large"),
+		   SIMPLE_STR("417 Expectation Failed"),
 		   SIMPLE_STR("500 Internal Server Error"),
 		};
 
 		bool headersSent;
+		//the headers are complete and go out with the next body write
+		bool headersEnded;
 		bool statusWritten;
 		bool chunkedEncoding;
+		//HEAD request, the headers describe the body but it is never sent
+		bool headersOnly;
 		HTTPVersion responseVersion;
 		ConnectionMode connectionMode;
 
@@ -121,6 +138,9 @@ namespace SimpleHTTP {
 			NotFound,
 			MethodNotAllowed,
 			NotAcceptable,
+			LengthRequired,
+			PayloadTooLarge,
+			ExpectationFailed,
 			InternalServerError,
 		};
 
@@ -128,7 +148,7 @@ namespace SimpleHTTP {
 		 * adds a content length header to the buffer
 		 * don't call this more then once
 		 */
-		void addContentLengthHeader(int length);
+		void addContentLengthHeader(uint32_t length);
 		/*
 		 * writes a response header line to the buffer
 		 * calls to this method after the headers have already been sent are ignored
@@ -150,6 +170,11 @@ namespace SimpleHTTP {
 		* this can only be called once.
 		*/
 		bool writeHeader(Status status);
+		/**
+		 * writes the status line and headers of a profile built at startup in one copy
+		 * as writeHeader(Status) more headers can follow, false if the status was already written or it doesn't fit
+		 */
+		bool writeHeader(const ResponseProfile& profile);
 		/**
 		* write request body data to the buffer
 		* returns the count of bytes written
@@ -172,6 +197,13 @@ namespace SimpleHTTP {
 		* writes out the buffer to the network
 		**/
 		Result flush();
+		/**
+		 * sends 100 Continue if the client is waiting for it before sending the body (Expect: 100-continue)
+		 * happens automatically when the handler reads the body, call it directly to send it earlier
+		 * to reject the upload write an error status without reading the body, the connection is closed after
+		 * returns false if it wasn't needed or couldn't be sent
+		 */
+		bool sendContinue();
 		/**
 		* in the case of chunked transfer encoding sends the final chunk and the no more chunks marker
 		**/
@@ -202,9 +234,37 @@ namespace SimpleHTTP {
 		inline void setConnectionMode(ConnectionMode connMode) { connectionMode = connMode; }
 
 		inline ConnectionMode getConnectionMode() { return connectionMode; }
+		/**
+		 * idle time allowed before the next request on this connection, overrides the pools default for this response
+		 */
+		inline void setKeepaliveTimeout(uint32_t ms) { client->keepaliveTimeout = ms; }
 
 		inline bool getRemoteIPAddress(char* buf, int buflen) {
 			return client->getRemoteIPAddress(buf, buflen);
 		}
 	};
+
+	/**
+	 * the status line and fixed headers of a common response built once, see Response::writeHeader(const ResponseProfile&)
+	 * i.e. static const ResponseProfile jsonOk(Response::Ok, "application/json", "Cache-Control: no-store\r\n");
+	 */
+	class ResponseProfile {
+		friend class Response;
+	public:
+		static const int MaxSize = 256;
+		/**
+		 * headers are extra lines each ending in \r\n, contentType and headers may be null
+		 * check isValid() if the headers may not fit in MaxSize
+		 */
+		ResponseProfile(Response::Status status, const char* contentType = nullptr, const char* headers = nullptr);
+
+		inline bool isValid() const { return size > 0; }
+
+	private:
+		//starts with the HTTP/1.1 status line, the version is replaced for other versions
+		char block[MaxSize];
+		int size;
+
+		bool append(const char* data, int length);
+	};
 };
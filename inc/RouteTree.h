@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Request.h"
+#include <vector>
+#include <string>
+
+namespace SimpleHTTP {
+	/**
+	 * radix tree of URL paths to route indexes
+	 * a segment starting with : matches one path segment, i.e. /api/:id
+	 * a segment starting with * matches the rest of the path, i.e. a last segment of *file after /static (the name is optional)
+	 * static segments are preferred over params, params over wildcards
+	 *
+	 * nodes are only created by add(), find() never allocates or modifies the tree
+	 */
+	class RouteTree {
+	private:
+		struct Node {
+			//static text matched by this node
+			string prefix;
+			//static children, each starts with a different character
+			std::vector<Node*> children;
+			Node* paramChild;
+			Node* wildcardChild;
+			//name of the param or wildcard this node captures
+			string paramName;
+			int value;
+
+			Node() : paramChild(nullptr), wildcardChild(nullptr), value(-1) {}
+			~Node();
+		};
+
+		Node root;
+
+		static Node* addStatic(Node* node, const char* path, int length);
+		static int match(const Node* node, const char* path, int length, const char* pathStart, Request::PathParam* params, int maxParams, int* paramCount);
+
+	public:
+		/**
+		 * adds a route, if the path has already been added its existing value is kept
+		 * returns the value stored for the path
+		 */
+		int add(const string& path, int value);
+		/**
+		 * returns the value for the route matching path or -1
+		 * any query string is ignored, captured params are written to params as offsets in to path
+		 */
+		int find(const char* path, int length, Request::PathParam* params, int maxParams, int* paramCount) const;
+	};
+};
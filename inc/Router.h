@@ -23,38 +23,71 @@
 #include "Request.h"
 #include "Response.h"
 #include "ServerConnection.h"
+#include "ConnectionPool.h"
+#include "RouteTree.h"
+#include "StaticRoutes.h"
 #include <stdint.h>
 
 namespace SimpleHTTP {
-	typedef void (*RequestHandler) (Request* request, Response* response);
+	typedef RequestHandler (*StaticRouteLookup) (const char* path, int length);
 
 	//Request routing and connection management
 	class Router {
 	private:
-		static std::map<string, RequestHandler> handlers;
+		//handlers for one route path
+		struct RouteHandlers {
+			//added without a method, receives every method
+			RequestHandler any;
+			RequestHandler methods[Request::UnknownMethod];
+		};
+
+		static StaticRouteLookup staticRoutes;
+		static RouteTree routes;
+		//indexed by the values stored in routes
+		static std::vector<RouteHandlers> routeHandlers;
+
+		static RouteHandlers* addRoute(const string& path);
+		//405 or OPTIONS response listing the methods with a handler, false if there are none
+		static bool allowedMethodsHandler(RouteHandlers* route, Request* request, Response* response);
 		static RequestHandler defaultHandler;
 
 		static void internalDefaultHandler(Request* request, Response* response);
 
-		static const uint32_t KeepaliveTimeout = 60 * 1000;
-		static const int maxClientConnections = 10;
-		static ServerConnection clients[maxClientConnections];
-
-		static int lastConnectionsInUse;
+		static ConnectionPool defaultPool;
 	public:
+		static const int maxClientConnections = ConnectionPool::maxConnections;
 		/**
 		 * add URL path to handler (callback function) mapping
+		 * path may contain params /api/:id and end with a wildcard segment such as *file, see Request::getPathParam()
+		 * the handlers are read without locking from every pool so add them all before starting a ShardedServer
 		*/
 		static void addHandler(string path, RequestHandler handler);
+		/**
+		 * add a handler for only one method on path
+		 * other methods get 405 Method Not Allowed and OPTIONS is answered with the Allow header,
+		 * unless a handler for every method has also been added for the path, a GET handler also answers HEAD
+		 */
+		static void addHandler(Request::Method method, string path, RequestHandler handler);
 		/**
 		 * the handler to use when the path is not found in the handles map
 		 * pass null to restore the default
 		 */
 		static void setDefaultHandler(RequestHandler handler);
+		/**
+		 * set a compile time route table that is checked before the handlers added with addHandler()
+		 * i.e. Router::setStaticRoutes(StaticRoutes<Route<indexPath, index>>::find)
+		 */
+		static inline void setStaticRoutes(StaticRouteLookup lookup) { staticRoutes = lookup; }
+		/**
+		 * runs the handler registered for the request path
+		 */
+		static void handleRequest(Request* request, Response* response);
 
 		static void process();
 
 		static ServerConnection* getFreeConnection();
 		static int getConnectionsInUseCount();
+
+		static inline ConnectionPool* getDefaultPool() { return &defaultPool; }
 	};
 };
\ No newline at end of file
@@ -68,11 +68,14 @@ namespace SimpleHTTP {
 
 		static const int maxSendSize = ServerConnection::maxSendSize + 29;
 
-		static const int maxNumConnections = 10;
+		static const int maxNumConnections = SIMPLE_HTTP_MAX_SECURE_CONNECTIONS;
 
 		static SecureServerConnection wrappers[maxNumConnections];
 
 	public:
+		//static RAM taken by the TLS wrappers, in addition to Footprint::total
+		static constexpr size_t footprint = sizeof(wrappers);
+
 		static int loadPrivateKey(SimpleString* cert);
 		static int loadCert(SimpleString* cert);
 		static mbedtls_x509_crt* getCertChain();
@@ -85,6 +85,7 @@ namespace SimpleHTTP::Internal {
 		bool isReviceQueueEmpty();
 
 		int write(const void* dataptr, u16_t len, u8_t apiflags);
+		int writev(const WriteSegment* segments, int count);
 		//don't use */
 		err_t shutdown();
 
@@ -20,6 +20,7 @@
 #pragma once
 #include "Request.h"
 #include "BasicLWIPTransport.h"
+#include "TimerWheel.h"
 
 #if defined(_WIN32) || defined(__linux__)
 #include "mock-tcp.h"
@@ -38,6 +39,7 @@
 #endif
 using SimpleHTTP::Internal::Transport;
 namespace SimpleHTTP {
+	class ConnectionPool;
 	//HTTP client connection
 	class ServerConnection {
 	private:
@@ -66,10 +68,49 @@ namespace SimpleHTTP {
 		SimpleHTTP::Internal::BasicLWIPTransport defaultTransport;
 		Transport* transport;
 
+		//owning pool, keeps the in use count and ready queue
+		ConnectionPool* pool;
+		ServerConnection* nextReady;
+		bool queuedForProcessing;
+		friend class ConnectionPool;
+
+		//received bytes the body handler hasn't taken yet so not yet given back to the receive window
+		int recvHeld;
+		/**
+		 * gives count held bytes back to the transport, call with the network locked
+		 */
+		inline void releaseRecv(int count) {
+			recvHeld -= count;
+			if (transport != 0) {
+				transport->recved(count);
+			}
+		}
+		/**
+		 * matches recvHeld to the request once it has been processed, releasing what it no longer holds, call with the network locked
+		 */
+		inline void updateRecvHeld() {
+			int released = recvHeld - currentRequest.getRecvHeld();
+			if (released > 0) {
+				releaseRecv(released);
+			}
+			else {
+				recvHeld -= released;
+			}
+		}
+
+		void setTransport(Transport* t);
+
 	public:
-		static const int maxSendSize = 4096;
+		static const int maxSendSize = SIMPLE_HTTP_MAX_SEND_SIZE;
 
 		uint32_t lastRequestTime;
+		//idle time allowed after the last response before closing, 0 uses the pools default
+		uint32_t keepaliveTimeout;
+		TimerWheel::Timer keepaliveTimer;
+		/**
+		 * keepaliveTimeout or the pools default when it isn't set
+		 */
+		uint32_t getKeepaliveTimeout();
 
 		Request currentRequest;
 
@@ -86,8 +127,15 @@ namespace SimpleHTTP {
 			}
 		}
 
+		/**
+		 * bytes held back from the receive window, after dataReceived the server acknowledges the
+		 * received length less the change in this (which is negative if held bytes were released)
+		 */
+		inline int getRecvHeld() { return recvHeld; }
+
 		bool hijacted;
-		int closeOnceSent;
+		//close once everything queued so far has been sent, set when the response asked for the connection to close
+		bool closeOnceSent;
 
 		typedef Result(*DataReceived) (void* arg, uint8_t* data, uint16_t len);
 		DataReceived dataReceived;
@@ -121,7 +169,18 @@ namespace SimpleHTTP {
 		static const int WriteFlagNoFlush = Transport::WriteFlagNoFlush;
 
 		bool writeData(const uint8_t* data, int len, int writeFlags);
+		/**
+		 * writes the segments in one go so they can leave in the same packet, only WriteFlagNoLock applies
+		 * falls back to writeData() for each one if they don't all fit in the send buffer
+		 */
+		bool writeSegments(const Transport::WriteSegment* segments, int count, int writeFlags);
 
+		/**
+		 * true when there is nothing queued or waiting to be acknowledged
+		 */
+		inline bool allSent() {
+			return waitingForSendCompleteSize <= 0 && sendQueue.empty();
+		}
 		inline bool  hasAvailableSendBuffer() {
 			return transport && transport->getAvailableSendBuffer() > 0; // waitingForSendCompleteSize <= maxSendSize;
 		}
@@ -133,7 +192,7 @@ namespace SimpleHTTP {
 		inline bool closeWithOutLocking() {
 			if(transport){
 				transport->shutdown();
-				transport = 0;
+				setTransport(0);
 			}
 			runFreeSessionHandler();
 			dataReceived(dataReceivedArg, 0, 0);
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "SocketServer.h"
+#include <atomic>
+#include <future>
+#include <thread>
+
+namespace SimpleHTTP {
+	/**
+	 * runs a SocketServer on several worker threads (Linux)
+	 * each shard owns a ConnectionPool and a SO_REUSEPORT listening socket so shards share nothing
+	 * but the Router handlers, which are only read once started.
+	 *
+	 * WebsocketManager has a single global pool and should not be used from a sharded server
+	 */
+	class ShardedServer {
+	private:
+		struct Shard {
+			ConnectionPool pool;
+			SocketServer server;
+			std::thread thread;
+
+			Shard() : server(&pool) {}
+		};
+
+		static const int pollTimeoutMs = 10;
+
+		Shard* shards;
+		int shardCount;
+		std::atomic<bool> running;
+
+		static void run(ShardedServer* owner, Shard* shard, int port, std::promise<Result>* listening);
+
+	public:
+		ShardedServer();
+		~ShardedServer();
+		/**
+		 * opens a listening socket per shard and starts their threads
+		 * shardCount of 0 uses one shard per CPU core
+		 * add all Router handlers before calling this
+		 */
+		Result start(int port, int shardCount = 0);
+		/**
+		 * stops the worker threads and closes all connections
+		 */
+		void stop();
+
+		inline int getShardCount() { return shardCount; }
+	};
+};
@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Router.h"
+#include "SocketTransport.h"
+#if defined(SIMPLE_HTTP_IO_URING) && SIMPLE_HTTP_IO_URING == 1
+#include "IoUring.h"
+#endif
+
+namespace SimpleHTTP {
+	/**
+	 * HTTP server on POSIX sockets, for running the stack on Linux
+	 * connections are taken from a ConnectionPool (the Router pool by default) in the same way Server does with lwIP
+	 * so the same handlers are served without changes
+	 *
+	 * the event loop is epoll by default or io_uring when built with SIMPLE_HTTP_IO_URING
+	 */
+	class SocketServer {
+	private:
+		int listenFd;
+		ConnectionPool* pool;
+
+		Internal::SocketTransport transports[ConnectionPool::maxConnections];
+		Internal::SocketTransport* freeTransports;
+		Internal::SocketTransport* sentReports;
+
+		//after the response a closed connection waits this long for the client to close its side, discarding up to
+		//closeDrainLimit bytes it sends, so unread request data doesn't reset the connection before the response is read
+		static const uint32_t closeDrainTimeoutMs = 2000;
+		static const int closeDrainLimit = 64 * 1024;
+
+#if defined(SIMPLE_HTTP_IO_URING) && SIMPLE_HTTP_IO_URING == 1
+		static const int ringEntries = 256;
+		static const int recvBufferCount = 64;
+		static const int recvBufferSize = 4096;
+		static const uint16_t recvBufferGroup = 0;
+
+		Internal::IoUring ring;
+		static const __kernel_timespec closeDrainTimeout;
+
+		void armAccept();
+		void armRecv(Internal::SocketTransport* t);
+		void cancelRecv(Internal::SocketTransport* t);
+		void submitSend(Internal::SocketTransport* t);
+		/**
+		 * once the send buffer has gone, shuts down the write side and discards received data until the client closes
+		 */
+		void submitClose(Internal::SocketTransport* t);
+		void finishClose(Internal::SocketTransport* t);
+		void handleCompletion(const io_uring_cqe* cqe);
+#else
+		static const int maxEventsPerPoll = 64;
+		static const int recvBufferSize = 4096;
+
+		int epollFd;
+		uint8_t recvBuffer[recvBufferSize];
+		//transports in closeTransport() waiting to finish
+		int closingCount;
+
+		void acceptConnections();
+		void readData(Internal::SocketTransport* t);
+		/**
+		 * sends what's left in the buffer, then shuts down the write side and discards received data until the client closes
+		 */
+		void lingerClose(Internal::SocketTransport* t);
+		void finishClose(Internal::SocketTransport* t);
+#endif
+		Result openListenSocket(int port, bool reusePort);
+		/**
+		 * pairs a newly accepted socket with a free connection from the pool
+		 * returns null and closes the socket if there isn't one
+		 */
+		Internal::SocketTransport* acceptConnection(int fd);
+		/**
+		 * the equivalent of Server::tcp_recv_cb when the remote end closes or errors
+		 */
+		void closeConnection(Internal::SocketTransport* t);
+		/**
+		 * passes the bytes the kernel has accepted on to the connection
+		 * the equivalent of Server::tcp_sent_cb
+		 */
+		void reportSent();
+
+	public:
+		explicit SocketServer(ConnectionPool* pool = Router::getDefaultPool());
+		~SocketServer();
+		/**
+		 * opens a listening socket on all interfaces
+		 * with reusePort set several servers can listen on the same port and the kernel spreads connections between them
+		 * must be called from the thread that calls poll()
+		 */
+		Result listen(int port, bool reusePort = false);
+		/**
+		 * the port being listened on, i.e. the one picked when listen() was given 0, -1 if not listening
+		 */
+		int getPort();
+		/**
+		 * waits up to timeoutMs for socket events and dispatches them
+		 * call this from the main loop along side process() on the pool
+		 */
+		void poll(int timeoutMs);
+
+		//used by SocketTransport
+		/**
+		 * tries to send data without buffering it
+		 * returns the count of bytes taken, or -1 if the socket has failed
+		 */
+		int sendDirect(Internal::SocketTransport* t, const uint8_t* data, int len);
+		/**
+		 * as sendDirect() for several segments in one call
+		 */
+		int sendDirect(Internal::SocketTransport* t, const Internal::Transport::WriteSegment* segments, int count);
+		/**
+		 * starts sending the transports buffered data, returns false if the socket has failed
+		 */
+		bool flush(Internal::SocketTransport* t);
+		/**
+		 * closes the socket once any buffered data has gone, the transport is released when it's done
+		 */
+		void closeTransport(Internal::SocketTransport* t);
+		void queueSentReport(Internal::SocketTransport* t);
+		/**
+		 * reads the socket again after the connection stopped holding body data
+		 */
+		void resumeRead(Internal::SocketTransport* t);
+		void release(Internal::SocketTransport* t);
+	};
+};
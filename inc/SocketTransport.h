@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Transport.h"
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	class ServerConnection;
+	class SocketServer;
+}
+
+namespace SimpleHTTP::Internal
+{
+	/**
+	 * Transport over a POSIX socket owned by a SocketServer
+	 * writes are copied into a per connection send buffer and handed to the kernel as it accepts them,
+	 * this gives the same semantics as tcp_write()/tcp_sent() so ServerConnection works unchanged
+	 */
+	class SocketTransport : public Transport
+	{
+		friend class SimpleHTTP::SocketServer;
+	public:
+		//plays the same role as TCP_SND_BUF in lwIP
+		static const int sendBufferSize = 16 * 1024;
+	private:
+		int fd;
+		//shutdown() was called but the socket is waiting on the backend to finish closing it
+		bool closing;
+		//incremented each time the transport is reused, lets the backend drop stale completions
+		uint32_t generation;
+		//the connection holds body data it couldn't pass on, the socket isn't read until recved() releases it
+		bool readPaused;
+		//a multishot recv is outstanding (io_uring only)
+		bool recvArmed;
+		//while closing, the write side has been shut down and what the client sends is discarded until it closes
+		bool writeShutdown;
+		int drained;
+		uint32_t closeDeadline;
+		//the socket close has been submitted (io_uring only)
+		bool closeSubmitted;
+
+		uint8_t sendBuffer[sendBufferSize];
+		int sendBufferUsed;
+		//bytes at the front of sendBuffer currently owned by an in flight send (io_uring only)
+		int sendInFlight;
+		//bytes accepted by the kernel that have not been reported to the connection yet
+		int sentNotReported;
+
+		SocketServer* owner;
+		ServerConnection* conn;
+
+		SocketTransport* nextSentReport;
+		bool sentReportQueued;
+		SocketTransport* nextFree;
+
+		void assign(SocketServer* server, int socketFd, ServerConnection* connection);
+		/**
+		 * records bytes the kernel has taken, removing them from the front of the send buffer if fromBuffer is set
+		 */
+		void sent(int size, bool fromBuffer);
+
+	public:
+		SocketTransport() : fd(-1), closing(false), generation(0), readPaused(false), recvArmed(false), writeShutdown(false), drained(0), closeDeadline(0), closeSubmitted(false), sendBufferUsed(0), sendInFlight(0), sentNotReported(0),
+			owner(nullptr), conn(nullptr), nextSentReport(nullptr), sentReportQueued(false), nextFree(nullptr) {}
+
+		inline bool isOpen() { return fd >= 0 && !closing; }
+		/**
+		 * the data is always copied, so WriteFlagZeroCopy has no effect
+		 * WriteFlagNoFlush leaves the data in the send buffer until the next flush
+		 */
+		int write(const void* dataptr, u16_t len, uint8_t apiflags);
+		/**
+		 * all or nothing, ERR_MEM if the segments don't fit in the send buffer
+		 */
+		int writev(const WriteSegment* segments, int count);
+
+		err_t shutdown();
+		/**
+		 * held body data was taken, reading resumes once none is held
+		 * the equivalent of opening the receive window again with tcp_recved()
+		 */
+		void recved(int len);
+
+		int getAvailableSendBuffer() {
+			return sendBufferSize - sendBufferUsed;
+		}
+
+		bool getRemoteIPAddress(char* buf, int buflen);
+	};
+};
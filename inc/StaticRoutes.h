@@ -0,0 +1,209 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Request.h"
+#include "Response.h"
+#include <stdint.h>
+#include <string.h>
+#include <array>
+
+namespace SimpleHTTP {
+	typedef void (*RequestHandler) (Request* request, Response* response);
+
+	/**
+	 * a path and handler for StaticRoutes, the path is a constexpr char array
+	 * i.e static constexpr char apiPath[] = "/api"; then Route<apiPath, apiHandler>
+	 */
+	template <const char* p, RequestHandler h>
+	struct Route {
+	private:
+		static constexpr int pathLength() {
+			int n = 0;
+			while (p[n] != 0) {
+				n++;
+			}
+			return n;
+		}
+	public:
+		static constexpr const char* path = p;
+		static constexpr int length = pathLength();
+		static constexpr RequestHandler handler = h;
+	};
+
+	/**
+	 * route table built at compile time, exact paths only (the query string is ignored) and every method goes to the handler
+	 * paths are found with a minimal perfect hash (hash and displace) so a lookup is two hashes of the path and one compare
+	 * nothing is allocated and there is no startup cost, register it with Router::setStaticRoutes(Routes::find)
+	 *
+	 * using Routes = StaticRoutes<Route<indexPath, indexHandler>, Route<apiPath, apiHandler>>;
+	 */
+	template <typename... Routes>
+	class StaticRoutes {
+	private:
+		static constexpr int count = sizeof...(Routes);
+
+		struct Entry {
+			const char* path;
+			int length;
+			RequestHandler handler;
+		};
+		static constexpr Entry entries[count > 0 ? count : 1] = { { Routes::path, Routes::length, Routes::handler }... };
+
+		static constexpr int nextPowerOfTwo(int n) {
+			int p = 1;
+			while (p < n) {
+				p <<= 1;
+			}
+			return p;
+		}
+		//slots kept under 80% full so each bucket finds a displacement quickly
+		static constexpr int slotCount = nextPowerOfTwo(count + count / 4 + 1);
+		static constexpr int bucketCount = nextPowerOfTwo(count / 2 + 1);
+
+		//FNV-1a seeded with the displacement
+		static constexpr uint32_t hash(const char* s, int length, uint32_t seed) {
+			uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+			for (int i = 0; i < length; i++) {
+				h = (h ^ (uint8_t)s[i]) * 16777619u;
+			}
+			return h ^ (h >> 15);
+		}
+
+		static constexpr bool samePath(const Entry& a, const Entry& b) {
+			if (a.length != b.length) {
+				return false;
+			}
+			for (int i = 0; i < a.length; i++) {
+				if (a.path[i] != b.path[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static constexpr bool hasDuplicates() {
+			for (int i = 0; i < count; i++) {
+				for (int j = i + 1; j < count; j++) {
+					if (samePath(entries[i], entries[j])) {
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+		static_assert(!hasDuplicates(), "StaticRoutes has a path more than once");
+
+		struct Table {
+			std::array<uint32_t, bucketCount> displacement;
+			//index in to entries or -1
+			std::array<int, slotCount> slots;
+			bool complete;
+		};
+
+		static constexpr int arraySize = count > 0 ? count : 1;
+
+		static constexpr Table build() {
+			Table t{};
+			t.complete = true;
+			for (int i = 0; i < slotCount; i++) {
+				t.slots[i] = -1;
+			}
+
+			std::array<int, arraySize> bucketOf{};
+			std::array<int, bucketCount> bucketSize{};
+			for (int i = 0; i < count; i++) {
+				bucketOf[i] = hash(entries[i].path, entries[i].length, 0) & (bucketCount - 1);
+				bucketSize[bucketOf[i]]++;
+			}
+
+			//place the largest buckets first while there are the most free slots
+			std::array<bool, bucketCount> placed{};
+			for (int n = 0; n < bucketCount; n++) {
+				int bucket = -1;
+				for (int b = 0; b < bucketCount; b++) {
+					if (!placed[b] && (bucket == -1 || bucketSize[b] > bucketSize[bucket])) {
+						bucket = b;
+					}
+				}
+				placed[bucket] = true;
+				if (bucketSize[bucket] == 0) {
+					break;
+				}
+
+				std::array<int, arraySize> members{};
+				int memberCount = 0;
+				for (int i = 0; i < count; i++) {
+					if (bucketOf[i] == bucket) {
+						members[memberCount++] = i;
+					}
+				}
+
+				//find a displacement that puts every member of the bucket in a free slot
+				std::array<int, arraySize> memberSlots{};
+				bool found = false;
+				for (uint32_t d = 1; d < 100000 && !found; d++) {
+					found = true;
+					for (int m = 0; m < memberCount && found; m++) {
+						int slot = hash(entries[members[m]].path, entries[members[m]].length, d) & (slotCount - 1);
+						found = t.slots[slot] == -1;
+						for (int k = 0; k < m && found; k++) {
+							found = memberSlots[k] != slot;
+						}
+						memberSlots[m] = slot;
+					}
+					if (found) {
+						for (int m = 0; m < memberCount; m++) {
+							t.slots[memberSlots[m]] = members[m];
+						}
+						t.displacement[bucket] = d;
+					}
+				}
+				if (!found) {
+					t.complete = false;
+					return t;
+				}
+			}
+			return t;
+		}
+
+		static constexpr Table table = build();
+		static_assert(table.complete, "StaticRoutes could not build a perfect hash");
+
+	public:
+		/**
+		 * returns the handler for path or null
+		 */
+		static RequestHandler find(const char* path, int length) {
+			if (count == 0) {
+				return nullptr;
+			}
+			const char* query = (const char*)memchr(path, '?', length);
+			if (query != nullptr) {
+				length = query - path;
+			}
+			uint32_t d = table.displacement[hash(path, length, 0) & (bucketCount - 1)];
+			int index = table.slots[hash(path, length, d) & (slotCount - 1)];
+			if (index == -1 || entries[index].length != length || memcmp(entries[index].path, path, length) != 0) {
+				return nullptr;
+			}
+			return entries[index].handler;
+		}
+	};
+};
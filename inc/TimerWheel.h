@@ -0,0 +1,88 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <stdint.h>
+
+namespace SimpleHTTP {
+	/**
+	 * hierarchical timer wheel
+	 * timers are intrusive so scheduling never allocates, advance() only visits timers that are due
+	 * (or whose level is being cascaded down) rather than every registered timer
+	 *
+	 * not thread safe, schedule/cancel/advance must all be called from the same context
+	 */
+	class TimerWheel {
+	public:
+		typedef void (*Callback)(void* arg);
+
+		struct Timer {
+			Timer* next;
+			//address of the pointer that points at this timer, null when not scheduled
+			Timer** pprev;
+			uint32_t expires;
+			Callback callback;
+			void* arg;
+
+			Timer() : next(nullptr), pprev(nullptr), expires(0), callback(nullptr), arg(nullptr) {}
+
+			inline void init(Callback cb, void* cbArg) {
+				callback = cb;
+				arg = cbArg;
+			}
+
+			inline bool isScheduled() { return pprev != nullptr; }
+		};
+
+		static const uint32_t DefaultTickMs = 100;
+
+	private:
+		static const int slotBits = 4;
+		static const int slotsPerLevel = 1 << slotBits;
+		static const uint32_t slotMask = slotsPerLevel - 1;
+		static const int levels = 4;
+		//longest delay in ticks, longer delays are clamped
+		static const uint32_t maxDelayTicks = (1u << (slotBits * levels)) - 1;
+
+		Timer* slots[levels][slotsPerLevel];
+		uint32_t tickMs;
+		uint32_t currentTick;
+		uint32_t lastTime;
+		bool started;
+
+		void insert(Timer* timer);
+		void unlink(Timer* timer);
+		void cascade(int level);
+		void runTick();
+
+	public:
+		explicit TimerWheel(uint32_t tickMs = DefaultTickMs);
+		/**
+		 * (re)schedules timer to fire no sooner than delayMs from now
+		 * delays beyond the range of the wheel (65535 ticks) are clamped
+		 */
+		void schedule(Timer* timer, uint32_t delayMs);
+		void cancel(Timer* timer);
+		/**
+		 * moves the wheel forward to now (ms from os_getUnixTime()) and runs expired timers
+		 * callbacks may schedule or cancel any timer, including their own
+		 */
+		void advance(uint32_t now);
+	};
+};
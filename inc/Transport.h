@@ -37,11 +37,31 @@ namespace SimpleHTTP::Internal {
 		//don't copy the data
 		static const int WriteFlagZeroCopy = 2;
 		static const int WriteFlagNoFlush = 4;
+
+		//one piece of a vectored write
+		struct WriteSegment {
+			const void* data;
+			u16_t len;
+			//the data may not outlive the call
+			bool copy;
+		};
+
 		virtual err_t shutdown() = 0;
 		virtual int write(const void* dataptr, u16_t len, uint8_t apiflags) = 0;
+		/**
+		 * writes the segments as if they were one buffer and flushes once after the last
+		 * returns the bytes written (less than the total if the send buffer filled part way) or an err_t if none were
+		 * each transport maps WriteSegment::copy to its own write flags
+		 */
+		virtual int writev(const WriteSegment* segments, int count) = 0;
 
         virtual int getAvailableSendBuffer() = 0;
 
 		virtual bool getRemoteIPAddress(char *buf, int buflen) =0;
+		/**
+		 * opens the receive window by len bytes that were held back when they arrived
+		 * transports without a window to manage can ignore this
+		 */
+		virtual void recved(int) {}
 	};
 }
@@ -30,7 +30,7 @@ namespace SimpleHTTP
         typedef void (*FrameReceivedHandler)(SimpleHTTP::Websocket *socket, SimpleHTTP::Websocket::Frame *frame);
 
     private:
-        static const int poolSize = 5;
+        static const int poolSize = SIMPLE_HTTP_MAX_WEBSOCKETS;
         static Websocket connections[poolSize];
         static Websocket connectionBufferLock[poolSize];
         
@@ -41,9 +41,15 @@ namespace SimpleHTTP
         static Result dataReceivedHandler(void *arg, uint8_t *data, uint16_t len);
         static FrameReceivedHandler frameReceivedHandler;
 
+        static TimerWheel timers;
+        static void pingTimerExpired(void *arg);
+
     public:
         static int getConnectionsInUseCount();
+        //defaults for each sockets timeouts, see Websocket::pingInterval
         static const int pingInterval = 15000;
+        static const int pongTimeout = 30000;
+        static const int closeTimeout = 60000;
         static void process();
 
         static void upgradeHandler(Request *req, Response *resp);
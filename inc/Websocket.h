@@ -22,6 +22,7 @@
 #include "Request.h"
 #include "Response.h"
 #include "../inc/CBuffer.h"
+#include "TimerWheel.h"
 #define RTOS
 namespace SimpleHTTP
 {
@@ -60,8 +61,16 @@ namespace SimpleHTTP
 		uint32_t lastPongReceived;
 		uint32_t lastPingSent;
 
+		//per socket timeouts in ms, set to the WebsocketManager defaults on upgrade
+		uint32_t pingInterval;
+		//a close frame is sent if no pong has been received for this long
+		uint32_t pongTimeout;
+		//the connection is dropped if no pong has been received for this long
+		uint32_t closeTimeout;
+		TimerWheel::Timer pingTimer;
+
 	private:
-		static const int requestBufferSize = 2048;
+		static const int requestBufferSize = SIMPLE_HTTP_WEBSOCKET_BUFFER_SIZE;
 #if SIMPLE_HTTP_RTOS_MODE == 0
 		int _bufferLock;
 		inline int xSemaphoreCreateMutex() { return 0; }
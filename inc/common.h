@@ -19,6 +19,7 @@
  */
 #pragma once
 #include "../../simpleHTTPServer.conf.h"
+#include "config.h"
 #include <string>
 namespace SimpleHTTP{
     enum Result{
@@ -60,6 +61,12 @@ namespace SimpleHTTP{
 		std::string value;
 	};
 
+	//header name and value pointing in to the data they were parsed from
+	struct HTTPHeaderView {
+		SimpleString name;
+		SimpleString value;
+	};
+
 };
 
 extern "C" {
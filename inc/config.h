@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//defaults for the sizing options that can be overridden in simpleHTTPServer.conf.h
+//see the readme for the memory each one costs
+
+//client connection slots per ConnectionPool (Router has one, a ShardedServer one per shard)
+#ifndef SIMPLE_HTTP_MAX_CONNECTIONS
+#define SIMPLE_HTTP_MAX_CONNECTIONS 10
+#endif
+
+//TLS wrappers used by SecureServer, each one also takes a slot from the default pool
+#ifndef SIMPLE_HTTP_MAX_SECURE_CONNECTIONS
+#define SIMPLE_HTTP_MAX_SECURE_CONNECTIONS 10
+#endif
+
+//largest chunk handed to the transport in one write
+#ifndef SIMPLE_HTTP_MAX_SEND_SIZE
+#define SIMPLE_HTTP_MAX_SEND_SIZE 4096
+#endif
+
+//Websocket objects available to WebsocketManager
+#ifndef SIMPLE_HTTP_MAX_WEBSOCKETS
+#define SIMPLE_HTTP_MAX_WEBSOCKETS 5
+#endif
+
+//receive buffer embedded in each Websocket, must hold the largest frame expected
+#ifndef SIMPLE_HTTP_WEBSOCKET_BUFFER_SIZE
+#define SIMPLE_HTTP_WEBSOCKET_BUFFER_SIZE 2048
+#endif
+
+//store request headers as views in to the receive buffer instead of in Request::headers (a std::map)
+//removes the allocations per header, read them with Request::getHeader()
+#ifndef SIMPLE_HTTP_ZERO_COPY_HEADERS
+#define SIMPLE_HTTP_ZERO_COPY_HEADERS 0
+#endif
+
+//headers kept per request in zero copy mode, a request with more is rejected
+#ifndef SIMPLE_HTTP_MAX_HEADERS
+#define SIMPLE_HTTP_MAX_HEADERS 24
+#endif
+
+//bytes per connection that the request line, headers and receive buffer are allocated from
+//they go to the heap once it's full (see RequestArena::getHeapFallbackCount()), 0 always uses the heap
+//sized for a typical browser request, the header map needs more than the zero copy offsets
+#ifndef SIMPLE_HTTP_REQUEST_ARENA_SIZE
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+#define SIMPLE_HTTP_REQUEST_ARENA_SIZE 1024
+#else
+#define SIMPLE_HTTP_REQUEST_ARENA_SIZE 2048
+#endif
+#endif
+
+//fields kept by a FormFields (Request::getQuery() and readForm()), any more are ignored
+#ifndef SIMPLE_HTTP_MAX_FORM_FIELDS
+#define SIMPLE_HTTP_MAX_FORM_FIELDS 8
+#endif
+
+//bytes of pipelined requests taken while the current one is handled, past this the connection stops reading until it's done
+#ifndef SIMPLE_HTTP_MAX_PIPELINED_SIZE
+#define SIMPLE_HTTP_MAX_PIPELINED_SIZE 512
+#endif
+
+//add a Date header to every response once the system clock has been set (i.e. by SNTP)
+#ifndef SIMPLE_HTTP_DATE_HEADER
+#define SIMPLE_HTTP_DATE_HEADER 0
+#endif
+
+static_assert(SIMPLE_HTTP_MAX_CONNECTIONS > 0, "SIMPLE_HTTP_MAX_CONNECTIONS must be at least 1");
+static_assert(SIMPLE_HTTP_MAX_SECURE_CONNECTIONS > 0 && SIMPLE_HTTP_MAX_SECURE_CONNECTIONS <= SIMPLE_HTTP_MAX_CONNECTIONS,
+	"SIMPLE_HTTP_MAX_SECURE_CONNECTIONS must be between 1 and SIMPLE_HTTP_MAX_CONNECTIONS");
+//writes are u16_t sized and SecureServer adds up to 29 bytes of TLS record overhead
+static_assert(SIMPLE_HTTP_MAX_SEND_SIZE >= 512 && SIMPLE_HTTP_MAX_SEND_SIZE <= 0xffff - 29, "SIMPLE_HTTP_MAX_SEND_SIZE must be between 512 and 65506");
+static_assert(SIMPLE_HTTP_MAX_WEBSOCKETS > 0, "SIMPLE_HTTP_MAX_WEBSOCKETS must be at least 1");
+static_assert(SIMPLE_HTTP_MAX_HEADERS > 0, "SIMPLE_HTTP_MAX_HEADERS must be at least 1");
+static_assert(SIMPLE_HTTP_MAX_FORM_FIELDS > 0, "SIMPLE_HTTP_MAX_FORM_FIELDS must be at least 1");
+static_assert(SIMPLE_HTTP_MAX_PIPELINED_SIZE > 0, "SIMPLE_HTTP_MAX_PIPELINED_SIZE must be at least 1");
+static_assert(SIMPLE_HTTP_REQUEST_ARENA_SIZE >= 0, "SIMPLE_HTTP_REQUEST_ARENA_SIZE can't be negative");
+//enough for the largest frame header (14 bytes) and a useful payload
+static_assert(SIMPLE_HTTP_WEBSOCKET_BUFFER_SIZE >= 128, "SIMPLE_HTTP_WEBSOCKET_BUFFER_SIZE must be at least 128");
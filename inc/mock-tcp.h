@@ -20,6 +20,7 @@
 #pragma once
 #include <stdint.h>
 #include <string.h>
+#include <stdio.h>
 //this is for testing
 //type definitions for lwip
 
@@ -66,13 +67,14 @@ typedef enum {
 
 typedef err_enum_t err_t;
 
-typedef short u16_t;
+typedef uint16_t u16_t;
 struct tcp_pcb {
 	void* arg;
 	int remote_ip;
 };
 
 #define TCP_WRITE_FLAG_COPY 1
+#define TCP_WRITE_FLAG_MORE 2
 
 inline err_t tcp_write(struct tcp_pcb* client,uint8_t* data,int size, uint8_t apiFlags) {
 	char buffer[1024 + 1] = "";
@@ -88,4 +90,11 @@ inline err_t tcp_close(struct tcp_pcb* client) { return ERR_OK; }
 
 inline err_t tcp_abort(struct tcp_pcb* client) { return ERR_OK; }
 
-inline int ip4addr_ntoa_r(int *v, char* b, int len);
\ No newline at end of file
+inline u16_t tcp_sndbuf(struct tcp_pcb* client) { return 0xffff; }
+
+inline void tcp_recved(struct tcp_pcb* client, u16_t len) {}
+
+inline char* ip4addr_ntoa_r(const int* v, char* b, int len) {
+	snprintf(b, len, "%d.%d.%d.%d", *v & 0xff, (*v >> 8) & 0xff, (*v >> 16) & 0xff, (*v >> 24) & 0xff);
+	return b;
+}
\ No newline at end of file
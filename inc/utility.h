@@ -18,13 +18,38 @@
  *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
  */
 #pragma once
+#include "common.h"
+#include <stdint.h>
 namespace SimpleHTTP {
 	class Utility {
 	private:
 		static  constexpr char ASCIILookup[] = { '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F' };
+		//"00" to "99", decimal digits are written two at a time from here
+		static const char DecimalPairs[200];
+		//any other base, a divide per digit
+		static int toASCIIDivide(uint32_t value, char* buffer, int base, int size);
 
 	public:
+		/**
+		 * writes value in base (2 to 16) to buffer without a terminator, returns the count of chars or 0 if it needs more than size
+		 */
 		static int toASCII(int value, char* buffer,int base, int size);
+		/**
+		 * as toASCII() in base 10, two digits per step
+		 */
+		static int formatDecimal(uint32_t value, char* buffer, int size);
+		/**
+		 * as toASCII() in base 16 (upper case), a byte per step
+		 */
+		static int formatHex(uint32_t value, char* buffer, int size);
+		/**
+		 * ASCII case insensitive compare of str with a null terminated string
+		 */
+		static bool equalsIgnoreCase(SimpleString str, const char* value);
+		/**
+		 * true if str contains the null terminated string value
+		 */
+		static bool contains(SimpleString str, const char* value);
 		static const int HexBase = 16;
 		static const int DecBase = 10;
 	};
@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ChunkedDecoder.h"
+#include <string.h>
+#include <limits.h>
+using namespace SimpleHTTP;
+
+static inline int hexDigit(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	c |= 0x20;
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+Result ChunkedDecoder::decode(const char* in, int* inSize, char* out, int* outSize) {
+	const char* pos = in;
+	const char* end = in + *inSize;
+	char* outPos = out;
+	char* outEnd = out + *outSize;
+
+	while (pos < end && state != Done && state != Failed) {
+		char c = *pos;
+		switch (state) {
+		case ChunkSize:
+		{
+			int digit = hexDigit(c);
+			if (digit >= 0) {
+				if (chunkRemaining > (INT_MAX >> 4)) {
+					state = Failed;
+					break;
+				}
+				chunkRemaining = chunkRemaining << 4 | digit;
+				sizeDigits++;
+			}
+			else if (sizeDigits == 0) {
+				state = Failed;
+				break;
+			}
+			else if (c == ';' || c == ' ' || c == '\t') {
+				state = ChunkExtension;
+			}
+			else if (c == '\r') {
+				state = ChunkSizeLF;
+			}
+			else if (c == '\n') {
+				state = chunkRemaining == 0 ? TrailerStart : ChunkData;
+			}
+			else {
+				state = Failed;
+				break;
+			}
+			pos++;
+			break;
+		}
+		case ChunkExtension:
+		{
+			//not used, skip to the end of the line
+			auto eol = (const char*)memchr(pos, '\n', end - pos);
+			if (eol == nullptr) {
+				pos = end;
+				break;
+			}
+			pos = eol + 1;
+			state = chunkRemaining == 0 ? TrailerStart : ChunkData;
+			break;
+		}
+		case ChunkSizeLF:
+			if (c != '\n') {
+				state = Failed;
+				break;
+			}
+			pos++;
+			state = chunkRemaining == 0 ? TrailerStart : ChunkData;
+			break;
+		case ChunkData:
+		{
+			int size = chunkRemaining;
+			if (size > end - pos) {
+				size = end - pos;
+			}
+			if (size > outEnd - outPos) {
+				size = outEnd - outPos;
+			}
+			if (size == 0) {
+				//out is full
+				goto stop;
+			}
+			//in and out may be the same buffer
+			memmove(outPos, pos, size);
+			outPos += size;
+			pos += size;
+			chunkRemaining -= size;
+			if (chunkRemaining == 0) {
+				state = ChunkDataCR;
+			}
+			break;
+		}
+		case ChunkDataCR:
+			if (c == '\r') {
+				state = ChunkDataLF;
+			}
+			else if (c == '\n') {
+				state = ChunkSize;
+				sizeDigits = 0;
+			}
+			else {
+				state = Failed;
+				break;
+			}
+			pos++;
+			break;
+		case ChunkDataLF:
+			if (c != '\n') {
+				state = Failed;
+				break;
+			}
+			pos++;
+			state = ChunkSize;
+			sizeDigits = 0;
+			break;
+		case TrailerStart:
+			if (c == '\r') {
+				state = EndLF;
+			}
+			else if (c == '\n') {
+				state = Done;
+			}
+			else {
+				state = TrailerLine;
+			}
+			pos++;
+			break;
+		case TrailerLine:
+		{
+			auto eol = (const char*)memchr(pos, '\n', end - pos);
+			if (eol == nullptr) {
+				pos = end;
+				break;
+			}
+			pos = eol + 1;
+			state = TrailerStart;
+			break;
+		}
+		case EndLF:
+			if (c != '\n') {
+				state = Failed;
+				break;
+			}
+			pos++;
+			state = Done;
+			break;
+		default:
+			break;
+		}
+	}
+stop:
+	*inSize = pos - in;
+	*outSize = outPos - out;
+	if (state == Failed) {
+		return ERROR;
+	}
+	return state == Done ? OK : MoreData;
+}
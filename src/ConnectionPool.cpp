@@ -0,0 +1,253 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ConnectionPool.h"
+#include "Router.h"
+#include "log.h"
+#include "utility.h"
+using namespace SimpleHTTP;
+
+ConnectionPool::ConnectionPool() : lastConnectionsInUse(0), connectionsInUse(0), keepaliveTimeout(KeepaliveTimeout), readyHead(nullptr), readyTail(nullptr)
+{
+	for (int i = 0; i < maxConnections; i++)
+	{
+		clients[i].pool = this;
+		clients[i].keepaliveTimer.init(keepaliveExpired, &clients[i]);
+	}
+}
+
+void ConnectionPool::queueForProcessing(ServerConnection* conn)
+{
+	//called in the network context (tcpip core lock held if enabled)
+	if (conn->queuedForProcessing) {
+		return;
+	}
+	conn->queuedForProcessing = true;
+	conn->nextReady = nullptr;
+	if (readyTail != nullptr) {
+		readyTail->nextReady = conn;
+	}
+	else {
+		readyHead = conn;
+	}
+	readyTail = conn;
+}
+
+void ConnectionPool::process()
+{
+	auto connCountInUse = getConnectionsInUseCount();
+	if( lastConnectionsInUse != connCountInUse){
+		SHTTP_LOGI(__FUNCTION__,"%d connections in use",connCountInUse);
+		lastConnectionsInUse = connCountInUse;
+	}
+
+	timers.advance(os_getUnixTime());
+
+	//take the whole queue so anything queued while handlers run waits for the next call
+	LOCK_TCPIP_CORE();
+	ServerConnection* client = readyHead;
+	readyHead = nullptr;
+	readyTail = nullptr;
+	UNLOCK_TCPIP_CORE();
+
+	while (client != nullptr)
+	{
+		auto next = client->nextReady;
+		client->nextReady = nullptr;
+		client->queuedForProcessing = false;
+		processConnection(client);
+		client = next;
+	}
+}
+
+void ConnectionPool::processConnection(ServerConnection* client)
+{
+	//the connection may have been closed or reused since it was queued, what queued it already cleared the check
+	if (!client->isConnected() || !client->currentRequest.receivedAllHeaders())
+	{
+		return;
+	}
+
+	//the route handler already ran for a streamed body, only the end needs a response
+	if (client->currentRequest.isBodyStreaming() && !streamBody(client))
+	{
+		return;
+	}
+
+	bool connectionKeepAlive = false;
+	auto connHeader = client->currentRequest.header(HeaderId::Connection);
+	if (Utility::equalsIgnoreCase(connHeader, "keep-alive")
+		//HTTP/1.1 connections are persistent unless the client says otherwise
+		|| (client->currentRequest.version == HTTPVersion::HTTP11 && !Utility::equalsIgnoreCase(connHeader, "close"))
+	#if defined(SIMPLE_HTTP_RTSP_SUPPORT) && SIMPLE_HTTP_RTSP_SUPPORT == 1
+		//RTSP is keepalive by default
+		|| client->currentRequest.version == HTTPVersion::RTSP10
+	#endif
+	){
+		connectionKeepAlive = true;
+	}
+
+	Response resp(client, connectionKeepAlive,client->currentRequest.version);
+	int bodyBuffered = 0;
+	client->keepaliveTimeout = 0;
+	if (client->currentRequest.isBodyStreaming())
+	{
+		client->currentRequest.endBody(&resp);
+	}
+	else
+	{
+		bodyBuffered = client->currentRequest.getBodyBuffered();
+		Router::handleRequest(&client->currentRequest, &resp);
+		if (client->currentRequest.isBodyReadInProgress())
+		{
+			//the handler wants the body, a client waiting on Expect: 100-continue won't send it otherwise
+			resp.sendContinue();
+			//body received before it was claimed was held
+			LOCK_TCPIP_CORE();
+			client->updateRecvHeld();
+			UNLOCK_TCPIP_CORE();
+		}
+		else if (client->currentRequest.hasUnreadBody())
+		{
+			//rejected before reading the body (or it was ignored), it can't be skipped reliably so don't reuse the connection
+			resp.setConnectionMode(Response::ConnectionClose);
+		}
+		//the handler asked for the body to be streamed to it
+		if (client->currentRequest.bodyChunkHandler != nullptr)
+		{
+			LOCK_TCPIP_CORE();
+			client->currentRequest.beginBodyStream();
+			UNLOCK_TCPIP_CORE();
+			if (!streamBody(client))
+			{
+				return;
+			}
+			client->currentRequest.endBody(&resp);
+		}
+	}
+
+	if( ! client->currentRequest.isBodyReadInProgress() ){
+		resp.finalize();
+
+		client->lastRequestTime = os_getUnixTime();
+		if (resp.getConnectionMode() == Response::ConnectionClose)
+		{
+			client->currentRequest.reset();
+			//counting bytes from here would include earlier responses still being sent, so wait for all of it
+			LOCK_TCPIP_CORE();
+			client->updateRecvHeld();
+			if (client->allSent())
+			{
+				client->closeWithOutLocking();
+			}
+			else
+			{
+				client->closeOnceSent = true;
+			}
+			UNLOCK_TCPIP_CORE();
+		}
+		else if (!client->hijacted)
+		{
+			client->keepaliveTimeout = client->getKeepaliveTimeout();
+			timers.schedule(&client->keepaliveTimer, client->keepaliveTimeout);
+
+			//requests pipelined behind this one are parsed now and queued below
+			LOCK_TCPIP_CORE();
+			auto result = client->currentRequest.next();
+			client->updateRecvHeld();
+			//checked as newly received data would be
+			if (result != ERROR && client->currentRequest.getAndClearForProcessing())
+			{
+				queueForProcessing(client);
+			}
+			UNLOCK_TCPIP_CORE();
+			if (result == ERROR)
+			{
+				client->close();
+				return;
+			}
+		}
+		else
+		{
+			LOCK_TCPIP_CORE();
+			client->currentRequest.reset();
+			client->updateRecvHeld();
+			UNLOCK_TCPIP_CORE();
+		}
+	}else{
+		//TODO allow data to be written while a body receive is in progress
+		//resp.flush();
+
+		//the handler read some of the body but left the rest buffered, no more data may arrive to queue it again
+		int remaining = client->currentRequest.getBodyBuffered();
+		if (remaining > 0 && remaining < bodyBuffered)
+		{
+			LOCK_TCPIP_CORE();
+			queueForProcessing(client);
+			UNLOCK_TCPIP_CORE();
+		}
+	}
+}
+
+bool ConnectionPool::streamBody(ServerConnection* client)
+{
+	auto& request = client->currentRequest;
+	LOCK_TCPIP_CORE();
+	request.deliverBufferedBody();
+	client->updateRecvHeld();
+	bool complete = request.parsingStage == Request::WaitingComplete;
+	//still has data the handler couldn't take, offer it again on the next call
+	if (!complete && request.getBodyBuffered() > 0)
+	{
+		queueForProcessing(client);
+	}
+	UNLOCK_TCPIP_CORE();
+	return complete;
+}
+
+void ConnectionPool::keepaliveExpired(void* arg)
+{
+	//the timer is only ever cancelled by rescheduling, so check the connection is still idle
+	auto client = static_cast<ServerConnection*>(arg);
+	if (!client->isConnected() || client->queuedForProcessing || client->hijacted || client->lastRequestTime == 0)
+	{
+		return;
+	}
+
+	uint32_t idle = os_getUnixTime() - client->lastRequestTime;
+	if (idle < client->keepaliveTimeout)
+	{
+		client->pool->timers.schedule(&client->keepaliveTimer, client->keepaliveTimeout - idle);
+		return;
+	}
+
+	SHTTP_LOGI(__FUNCTION__,"closing http connection");
+	client->close();
+}
+
+ServerConnection* ConnectionPool::getFreeConnection() {
+	for (int i = 0; i < maxConnections; i++)
+	{
+		if (!clients[i].isConnected())
+		{
+            return &clients[i];
+        }
+    }
+    return nullptr;
+}
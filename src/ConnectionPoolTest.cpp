@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "ConnectionPool.h"
+#include "Router.h"
+#include "MockServerConnection.h"
+#include <memory>
+#include <string>
+using namespace SimpleHTTP;
+using SimpleHTTPTest::MockTransport;
+using std::string;
+
+static int handledA;
+static int handledB;
+
+static void poolHandlerA(Request* req, Response* resp) {
+	handledA++;
+	resp->write("a");
+}
+
+static void poolHandlerB(Request* req, Response* resp) {
+	handledB++;
+	resp->write("b");
+}
+
+//a pool connection on a mock transport, data is fed in as the network callbacks would
+static ServerConnection* connect(ConnectionPool* pool, MockTransport* transport, string* buffer) {
+	transport->buffer = buffer;
+	auto conn = pool->getFreeConnection();
+	conn->init(nullptr, transport);
+	return conn;
+}
+
+static void receive(ServerConnection* conn, const char* data) {
+	conn->dataReceived(conn->dataReceivedArg, (uint8_t*)data, strlen(data));
+}
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+	//declared before the pool so they outlive its connections
+	MockTransport transportA, transportB;
+	string bufferA, bufferB;
+	std::unique_ptr<ConnectionPool> pool;
+
+	void SetUp() override {
+		Router::addHandler(Request::GET, "/pool/a", poolHandlerA);
+		Router::addHandler(Request::GET, "/pool/b", poolHandlerB);
+		handledA = 0;
+		handledB = 0;
+		pool.reset(new ConnectionPool());
+	}
+};
+
+TEST_F(ConnectionPoolTest, OnlyReadyConnectionsProcessed) {
+	auto a = connect(pool.get(), &transportA, &bufferA);
+	auto b = connect(pool.get(), &transportB, &bufferB);
+	ASSERT_NE(a, b);
+
+	receive(a, "GET /pool/a HTTP/1.1\r\nHost: test\r\n\r\n");
+	receive(b, "GET /pool/b HTTP/1.1\r\nHost: te");
+	pool->process();
+	ASSERT_EQ(handledA, 1);
+	ASSERT_EQ(handledB, 0);
+	ASSERT_EQ(bufferA.find("HTTP/1.1 200 OK\r\n"), 0);
+	ASSERT_EQ(bufferB, "");
+
+	//nothing is queued until more data arrives
+	pool->process();
+	ASSERT_EQ(handledA, 1);
+	ASSERT_EQ(handledB, 0);
+
+	receive(b, "st\r\n\r\n");
+	pool->process();
+	ASSERT_EQ(handledA, 1);
+	ASSERT_EQ(handledB, 1);
+	ASSERT_EQ(bufferB.find("HTTP/1.1 200 OK\r\n"), 0);
+}
+
+TEST_F(ConnectionPoolTest, QueuedOnce) {
+	auto a = connect(pool.get(), &transportA, &bufferA);
+
+	//data arriving while already queued doesn't queue it again, so it is processed once per request
+	receive(a, "GET /pool/a HTTP/1.1\r\nHost: test\r\n\r\n");
+	receive(a, "GET /pool/a HTTP/1.1\r\nHost: test\r\n\r\n");
+	pool->process();
+	ASSERT_EQ(handledA, 1);
+
+	//the pipelined request was parsed after the first response and queued for the next call
+	pool->process();
+	ASSERT_EQ(handledA, 2);
+
+	pool->process();
+	ASSERT_EQ(handledA, 2);
+	ASSERT_EQ(pool->getConnectionsInUseCount(), 1);
+}
+
+static int uploadRuns;
+static string uploadBody;
+
+static void poolUploadHandler(Request* req, Response* resp) {
+	uploadRuns++;
+	char buffer[64];
+	int size = sizeof(buffer);
+	auto result = req->readBody(buffer, &size);
+	if (result != ERROR) {
+		uploadBody.append(buffer, size);
+	}
+	if (result == OK) {
+		resp->write("done");
+	}
+}
+
+TEST_F(ConnectionPoolTest, PartialBodyRunsOnNewData) {
+	Router::addHandler(Request::POST, "/pool/upload", poolUploadHandler);
+	uploadRuns = 0;
+	uploadBody.clear();
+	auto a = connect(pool.get(), &transportA, &bufferA);
+
+	receive(a, "POST /pool/upload HTTP/1.1\r\nHost: test\r\nContent-Length: 6\r\n\r\nab");
+	pool->process();
+	ASSERT_EQ(uploadRuns, 1);
+	ASSERT_EQ(uploadBody, "ab");
+
+	//nothing new received, the handler isn't run again
+	pool->process();
+	pool->process();
+	ASSERT_EQ(uploadRuns, 1);
+
+	receive(a, "cd");
+	pool->process();
+	ASSERT_EQ(uploadRuns, 2);
+	pool->process();
+	ASSERT_EQ(uploadRuns, 2);
+
+	receive(a, "ef");
+	pool->process();
+	ASSERT_EQ(uploadRuns, 3);
+	ASSERT_EQ(uploadBody, "abcdef");
+	ASSERT_EQ(bufferA.find("HTTP/1.1 200 OK\r\n"), 0);
+	ASSERT_EQ(bufferA.substr(bufferA.size() - 4), "done");
+}
+
+TEST_F(ConnectionPoolTest, UnclaimedBodyHeld) {
+	Router::addHandler(Request::POST, "/pool/upload", poolUploadHandler);
+	uploadRuns = 0;
+	uploadBody.clear();
+	auto a = connect(pool.get(), &transportA, &bufferA);
+
+	//held from the receive window until the handler reads it
+	receive(a, "POST /pool/upload HTTP/1.1\r\nHost: test\r\nContent-Length: 6\r\n\r\nab");
+	ASSERT_EQ(a->getRecvHeld(), 2);
+	pool->process();
+	ASSERT_EQ(uploadRuns, 1);
+	ASSERT_EQ(a->getRecvHeld(), 0);
+
+	receive(a, "cdef");
+	ASSERT_EQ(a->getRecvHeld(), 0);
+}
@@ -0,0 +1,90 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DateHeader.h"
+#include <string.h>
+using namespace SimpleHTTP;
+
+SimpleString DateHeader::get() {
+	thread_local char line[Size];
+	thread_local uint32_t formattedAt;
+	thread_local bool valid;
+	thread_local bool formatted;
+
+	uint32_t now = os_getUnixTime();
+	if (!formatted || now - formattedAt >= 1000) {
+		time_t seconds = time(nullptr);
+		valid = seconds >= MinValidTime;
+		if (valid) {
+			format(seconds, line);
+		}
+		formattedAt = now;
+		formatted = true;
+	}
+	if (!valid) {
+		return { nullptr, 0 };
+	}
+	return { line, Size };
+}
+
+static inline char* twoDigits(char* out, int value) {
+	out[0] = '0' + value / 10;
+	out[1] = '0' + value % 10;
+	return out + 2;
+}
+
+void DateHeader::format(time_t seconds, char* out) {
+	static const char days[] = "ThuFriSatSunMonTueWed";
+	static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+	int64_t day = seconds / 86400;
+	int secondOfDay = seconds % 86400;
+
+	//civil date from days since 1970-01-01 (Howard Hinnant's algorithm)
+	int64_t z = day + 719468;
+	int64_t era = z / 146097;
+	int dayOfEra = z - era * 146097;
+	int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int mp = (5 * dayOfYear + 2) / 153;
+	int dayOfMonth = dayOfYear - (153 * mp + 2) / 5 + 1;
+	int month = mp < 10 ? mp + 3 : mp - 9;
+	int year = yearOfEra + era * 400 + (month <= 2);
+
+	memcpy(out, "Date: ", 6);
+	out += 6;
+	memcpy(out, days + (day % 7) * 3, 3);
+	out[3] = ',';
+	out[4] = ' ';
+	out = twoDigits(out + 5, dayOfMonth);
+	*out++ = ' ';
+	memcpy(out, months + (month - 1) * 3, 3);
+	out[3] = ' ';
+	out = twoDigits(out + 4, year / 100);
+	out = twoDigits(out, year % 100);
+	*out++ = ' ';
+	out = twoDigits(out, secondOfDay / 3600);
+	*out++ = ':';
+	out = twoDigits(out, secondOfDay / 60 % 60);
+	*out++ = ':';
+	out = twoDigits(out, secondOfDay % 60);
+	memcpy(out, " GMT\r\n", 6);
+}
+
+const int DateHeader::Size;
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DelimiterScanner.h"
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+using namespace SimpleHTTP;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+namespace {
+#if defined(__SSE2__)
+	//bits in the match masks per byte of the block
+	const int MaskBitsPerByte = 1;
+#else
+	const int MaskBitsPerByte = 4;
+#endif
+
+	//adds the matches in one block, the masks only have bits for bytes before the end of the line
+	inline void recordBlock(const char* block, uint64_t spaces, uint64_t colons, DelimiterScanner::Line* line) {
+		if (spaces != 0) {
+			if (line->firstSpace == nullptr) {
+				line->firstSpace = block + __builtin_ctzll(spaces) / MaskBitsPerByte;
+			}
+			line->lastSpace = block + (63 - __builtin_clzll(spaces)) / MaskBitsPerByte;
+		}
+		if (colons != 0 && line->colon == nullptr) {
+			line->colon = block + __builtin_ctzll(colons) / MaskBitsPerByte;
+		}
+	}
+}
+#endif
+
+void DelimiterScanner::scanLine(const char* ptr, const char* end, Line* line) {
+	*line = {};
+#if defined(__SSE2__)
+	const __m128i eol16 = _mm_set1_epi8('\n');
+	const __m128i space16 = _mm_set1_epi8(' ');
+	const __m128i colon16 = _mm_set1_epi8(':');
+	while (end - ptr >= 16) {
+		__m128i block = _mm_loadu_si128((const __m128i*)ptr);
+		uint64_t eols = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, eol16));
+		uint64_t spaces = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, space16));
+		uint64_t colons = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, colon16));
+#elif defined(__ARM_NEON)
+	const uint8x16_t eol16 = vdupq_n_u8('\n');
+	const uint8x16_t space16 = vdupq_n_u8(' ');
+	const uint8x16_t colon16 = vdupq_n_u8(':');
+	while (end - ptr >= 16) {
+		uint8x16_t block = vld1q_u8((const uint8_t*)ptr);
+		//narrow each byte to a nibble so the matches fit in 64 bits
+		uint64_t eols = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vceqq_u8(block, eol16)), 4)), 0);
+		uint64_t spaces = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vceqq_u8(block, space16)), 4)), 0);
+		uint64_t colons = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(vceqq_u8(block, colon16)), 4)), 0);
+#endif
+#if defined(__SSE2__) || defined(__ARM_NEON)
+		if (eols != 0) {
+			//only the bytes before the first \n
+			uint64_t before = (eols & (0 - eols)) - 1;
+			recordBlock(ptr, spaces & before, colons & before, line);
+			line->eol = ptr + __builtin_ctzll(eols) / MaskBitsPerByte;
+			return;
+		}
+		recordBlock(ptr, spaces, colons, line);
+		ptr += 16;
+	}
+#endif
+	scanBytes(ptr, end, line);
+}
+
+void DelimiterScanner::scanLineBytes(const char* ptr, const char* end, Line* line) {
+	*line = {};
+	scanBytes(ptr, end, line);
+}
+
+void DelimiterScanner::scanBytes(const char* ptr, const char* end, Line* line) {
+	for (; ptr < end; ptr++) {
+		switch (*ptr) {
+		case '\n':
+			line->eol = ptr;
+			return;
+		case ' ':
+			if (line->firstSpace == nullptr) {
+				line->firstSpace = ptr;
+			}
+			line->lastSpace = ptr;
+			break;
+		case ':':
+			if (line->colon == nullptr) {
+				line->colon = ptr;
+			}
+			break;
+		}
+	}
+}
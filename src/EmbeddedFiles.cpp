@@ -18,24 +18,25 @@
  *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "EmbeddedFiles.h"
+#include "utility.h"
 
 using SimpleHTTP::EmbeddedFile;
 using SimpleHTTP::EmbeddedFilesHandler;
 
 void EmbeddedFilesHandler::embeddedFilesHandler(Request* req, Response* resp) {
-	auto f = fileMap[req->path];
-	if (f == 0)
+	auto entry = fileMap.find(std::string_view(req->path.data(), req->path.size()));
+	if (entry == fileMap.end())
 	{
 		resp->writeHeader(SimpleHTTP::Response::NotFound);
 		resp->write("the path was not found");
 		return;
 	}
-
+	auto f = entry->second;
 
 	if (f->flags & 128)
 	{
-		auto accepts = req->headers["ACCEPT-ENCODING"];
-		if (!accepts.empty() && accepts.find("gzip") != string::npos)
+		auto accepts = req->header(HeaderId::AcceptEncoding);
+		if (SimpleHTTP::Utility::contains(accepts, "gzip"))
 		{
 			resp->writeHeaderLine(SIMPLE_STR("Content-Encoding: gzip"));
 		}
@@ -61,5 +62,5 @@ void EmbeddedFilesHandler::addFiles(EmbeddedFile* files, int filesCount,Embedded
 	fileTypes = types;
 }
 
-map<string, EmbeddedFile *> EmbeddedFilesHandler::fileMap;
+map<string, EmbeddedFile *, std::less<>> EmbeddedFilesHandler::fileMap;
 SimpleHTTP::EmbeddedFileType* EmbeddedFilesHandler::fileTypes;
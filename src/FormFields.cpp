@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FormFields.h"
+#include <string.h>
+using namespace SimpleHTTP;
+
+void FormFields::parse(char* data, int size) {
+	this->data = data;
+	count = 0;
+	//offsets are 16 bit
+	if (size > UINT16_MAX) {
+		size = UINT16_MAX;
+	}
+	const char* end = data + size;
+	const char* pos = data;
+	while (pos < end && count < MaxFields) {
+		auto ampersand = (const char*)memchr(pos, '&', end - pos);
+		const char* fieldEnd = ampersand ? ampersand : end;
+		if (fieldEnd != pos) {
+			auto equals = (const char*)memchr(pos, '=', fieldEnd - pos);
+			const char* nameEnd = equals ? equals : fieldEnd;
+			const char* value = equals ? equals + 1 : fieldEnd;
+			fields[count++] = {
+				(uint16_t)(pos - data), (uint16_t)(nameEnd - pos),
+				(uint16_t)(value - data), (uint16_t)(fieldEnd - value),
+				false, false
+			};
+		}
+		pos = fieldEnd + 1;
+	}
+}
+
+SimpleString FormFields::getName(int index) {
+	if (index < 0 || index >= count) {
+		return { nullptr, 0 };
+	}
+	auto& field = fields[index];
+	if (!field.nameDecoded) {
+		field.nameLength = decode(data + field.nameOffset, field.nameLength);
+		field.nameDecoded = true;
+	}
+	return { data + field.nameOffset, field.nameLength };
+}
+
+SimpleString FormFields::getValue(int index) {
+	if (index < 0 || index >= count) {
+		return { nullptr, 0 };
+	}
+	auto& field = fields[index];
+	if (!field.valueDecoded) {
+		field.valueLength = decode(data + field.valueOffset, field.valueLength);
+		field.valueDecoded = true;
+	}
+	return { data + field.valueOffset, field.valueLength };
+}
+
+SimpleString FormFields::get(const char* name) {
+	int length = strlen(name);
+	for (int i = 0; i < count; i++) {
+		auto fieldName = getName(i);
+		if (fieldName.size == length && memcmp(fieldName.value, name, length) == 0) {
+			return getValue(i);
+		}
+	}
+	return { nullptr, 0 };
+}
+
+static inline int hexValue(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	c |= 0x20;
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+int FormFields::decode(char* data, int size) {
+	//nothing to do for most names and values
+	int in = 0;
+	while (in < size && data[in] != '%' && data[in] != '+') {
+		in++;
+	}
+	int out = in;
+	while (in < size) {
+		char c = data[in++];
+		if (c == '+') {
+			c = ' ';
+		}
+		else if (c == '%' && in + 2 <= size) {
+			int high = hexValue(data[in]);
+			int low = hexValue(data[in + 1]);
+			if (high >= 0 && low >= 0) {
+				c = (char)(high << 4 | low);
+				in += 2;
+			}
+		}
+		data[out++] = c;
+	}
+	return out;
+}
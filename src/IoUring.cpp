@@ -0,0 +1,262 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "IoUring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+
+using SimpleHTTP::Internal::IoUring;
+
+static inline int ioUringSetup(unsigned entries, io_uring_params* p)
+{
+	int result = syscall(__NR_io_uring_setup, entries, p);
+	return result < 0 ? -errno : result;
+}
+
+static inline int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags, void* arg, size_t argSize)
+{
+	int result = syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, arg, argSize);
+	return result < 0 ? -errno : result;
+}
+
+static inline int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned argCount)
+{
+	int result = syscall(__NR_io_uring_register, fd, opcode, arg, argCount);
+	return result < 0 ? -errno : result;
+}
+
+IoUring::IoUring() : ringFd(-1), sqRingPtr(MAP_FAILED), sqRingSize(0), cqRingPtr(MAP_FAILED), cqRingSize(0), sqes((io_uring_sqe*)MAP_FAILED), sqesSize(0),
+	sqHead(nullptr), sqTail(nullptr), sqMask(0), sqEntries(0), sqLocalTail(0), cqHead(nullptr), cqTail(nullptr), cqMask(0), cqes(nullptr),
+	bufRing((io_uring_buf_ring*)MAP_FAILED), bufRingSize(0), bufRingMask(0), bufRingTail(0), bufMemory((uint8_t*)MAP_FAILED), bufMemorySize(0), bufSize(0)
+{
+}
+
+IoUring::~IoUring()
+{
+	destroy();
+}
+
+int IoUring::init(unsigned entries)
+{
+	io_uring_params p;
+	memset(&p, 0, sizeof(p));
+	p.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+	ringFd = ioUringSetup(entries, &p);
+	if (ringFd == -EINVAL) {
+		//older kernel without the task run hints
+		memset(&p, 0, sizeof(p));
+		ringFd = ioUringSetup(entries, &p);
+	}
+	if (ringFd < 0) {
+		return ringFd;
+	}
+
+	sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (cqRingSize > sqRingSize) {
+			sqRingSize = cqRingSize;
+		}
+		cqRingSize = sqRingSize;
+	}
+
+	sqRingPtr = mmap(0, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+	if (sqRingPtr == MAP_FAILED) {
+		return -errno;
+	}
+
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		cqRingPtr = sqRingPtr;
+	}
+	else {
+		cqRingPtr = mmap(0, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		if (cqRingPtr == MAP_FAILED) {
+			return -errno;
+		}
+	}
+
+	sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+	sqes = (io_uring_sqe*)mmap(0, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED) {
+		return -errno;
+	}
+
+	auto sq = (uint8_t*)sqRingPtr;
+	sqHead = (unsigned*)(sq + p.sq_off.head);
+	sqTail = (unsigned*)(sq + p.sq_off.tail);
+	sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+	sqEntries = p.sq_entries;
+	sqLocalTail = *sqTail;
+	//sqes are always used in order so the index array is a fixed identity mapping
+	auto sqArray = (unsigned*)(sq + p.sq_off.array);
+	for (unsigned i = 0; i < sqEntries; i++) {
+		sqArray[i] = i;
+	}
+
+	auto cq = (uint8_t*)cqRingPtr;
+	cqHead = (unsigned*)(cq + p.cq_off.head);
+	cqTail = (unsigned*)(cq + p.cq_off.tail);
+	cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+	cqes = (io_uring_cqe*)(cq + p.cq_off.cqes);
+
+	return 0;
+}
+
+void IoUring::destroy()
+{
+	if (bufMemory != MAP_FAILED) {
+		munmap(bufMemory, bufMemorySize);
+		bufMemory = (uint8_t*)MAP_FAILED;
+	}
+	if (bufRing != MAP_FAILED) {
+		munmap(bufRing, bufRingSize);
+		bufRing = (io_uring_buf_ring*)MAP_FAILED;
+	}
+	if (sqes != MAP_FAILED) {
+		munmap(sqes, sqesSize);
+		sqes = (io_uring_sqe*)MAP_FAILED;
+	}
+	if (cqRingPtr != MAP_FAILED && cqRingPtr != sqRingPtr) {
+		munmap(cqRingPtr, cqRingSize);
+	}
+	cqRingPtr = MAP_FAILED;
+	if (sqRingPtr != MAP_FAILED) {
+		munmap(sqRingPtr, sqRingSize);
+		sqRingPtr = MAP_FAILED;
+	}
+	if (ringFd >= 0) {
+		close(ringFd);
+		ringFd = -1;
+	}
+}
+
+io_uring_sqe* IoUring::getSqe()
+{
+	if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+		submitAndWait(0, 0);
+		if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+			return nullptr;
+		}
+	}
+
+	auto sqe = &sqes[sqLocalTail & sqMask];
+	sqLocalTail++;
+	memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+int IoUring::submitAndWait(unsigned waitCount, int timeoutMs)
+{
+	unsigned toSubmit = sqLocalTail - *sqTail;
+	__atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+
+	unsigned flags = 0;
+	__kernel_timespec ts;
+	io_uring_getevents_arg arg;
+	memset(&arg, 0, sizeof(arg));
+
+	if (waitCount > 0) {
+		if (peekCqe() != nullptr) {
+			//already have work, don't block
+			waitCount = 0;
+		}
+		else {
+			flags |= IORING_ENTER_GETEVENTS;
+			if (timeoutMs >= 0) {
+				ts.tv_sec = timeoutMs / 1000;
+				ts.tv_nsec = (timeoutMs % 1000) * 1000000L;
+				arg.sigmask_sz = _NSIG / 8;
+				arg.ts = (uint64_t)&ts;
+				flags |= IORING_ENTER_EXT_ARG;
+			}
+		}
+	}
+
+	if (toSubmit == 0 && waitCount == 0) {
+		return 0;
+	}
+
+	int result = ioUringEnter(ringFd, toSubmit, waitCount, flags, (flags & IORING_ENTER_EXT_ARG) ? &arg : nullptr, (flags & IORING_ENTER_EXT_ARG) ? sizeof(arg) : 0);
+	if (result == -ETIME || result == -EINTR) {
+		return 0;
+	}
+	return result;
+}
+
+io_uring_cqe* IoUring::peekCqe()
+{
+	unsigned head = *cqHead;
+	if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) {
+		return nullptr;
+	}
+	return &cqes[head & cqMask];
+}
+
+void IoUring::cqeSeen()
+{
+	__atomic_store_n(cqHead, *cqHead + 1, __ATOMIC_RELEASE);
+}
+
+int IoUring::setupBufferRing(uint16_t groupId, unsigned count, int size)
+{
+	bufRingSize = count * sizeof(io_uring_buf);
+	bufRing = (io_uring_buf_ring*)mmap(0, bufRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	if (bufRing == MAP_FAILED) {
+		return -errno;
+	}
+
+	bufSize = size;
+	bufMemorySize = (size_t)count * size;
+	bufMemory = (uint8_t*)mmap(0, bufMemorySize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+	if (bufMemory == MAP_FAILED) {
+		return -errno;
+	}
+
+	io_uring_buf_reg reg;
+	memset(&reg, 0, sizeof(reg));
+	reg.ring_addr = (uint64_t)bufRing;
+	reg.ring_entries = count;
+	reg.bgid = groupId;
+	int result = ioUringRegister(ringFd, IORING_REGISTER_PBUF_RING, &reg, 1);
+	if (result < 0) {
+		return result;
+	}
+
+	bufRingMask = count - 1;
+	bufRingTail = 0;
+	for (unsigned i = 0; i < count; i++) {
+		recycleBuffer(i);
+	}
+	return 0;
+}
+
+void IoUring::recycleBuffer(uint16_t bufferId)
+{
+	//not using bufRing->bufs, in C++ the empty struct in __DECLARE_FLEX_ARRAY moves it off the start of the ring
+	auto buf = (io_uring_buf*)bufRing + (bufRingTail & bufRingMask);
+	buf->addr = (uint64_t)getBuffer(bufferId);
+	buf->len = bufSize;
+	buf->bid = bufferId;
+	bufRingTail++;
+	__atomic_store_n(&bufRing->tail, bufRingTail, __ATOMIC_RELEASE);
+}
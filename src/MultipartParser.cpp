@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "MultipartParser.h"
+#include "Request.h"
+#include "utility.h"
+#include <string.h>
+using namespace SimpleHTTP;
+
+MultipartParser::MultipartParser() : state(Failed), delimiterLength(0), carryLength(0), partHeadersLength(0), afterBoundaryLength(0),
+	headerHandler(nullptr), dataHandler(nullptr), endHandler(nullptr), handlerArg(nullptr) {
+}
+
+Result MultipartParser::begin(SimpleString contentType, PartHeaderHandler onHeader, PartDataHandler onData, PartEndHandler onEnd, void* arg) {
+	state = Failed;
+	static const int prefixLength = sizeof("multipart/") - 1;
+	if (contentType.value == nullptr || contentType.size < prefixLength || !Utility::equalsIgnoreCase({ contentType.value, prefixLength }, "multipart/")) {
+		return ERROR;
+	}
+	auto boundary = getHeaderParam(contentType, "boundary");
+	if (boundary.value == nullptr || boundary.size == 0 || boundary.size > MaxBoundaryLength) {
+		return ERROR;
+	}
+
+	memcpy(delimiter, "\r\n--", 4);
+	memcpy(delimiter + 4, boundary.value, boundary.size);
+	delimiterLength = boundary.size + 4;
+
+	//distance from the last occurrence of each byte (ignoring the final one) to the end of the delimiter
+	memset(skip, delimiterLength, sizeof(skip));
+	for (int i = 0; i < delimiterLength - 1; i++) {
+		skip[(uint8_t)delimiter[i]] = delimiterLength - 1 - i;
+	}
+
+	//the first boundary doesn't need a CRLF before it
+	memcpy(carry, "\r\n", 2);
+	carryLength = 2;
+	partHeadersLength = 0;
+	afterBoundaryLength = 0;
+
+	headerHandler = onHeader;
+	dataHandler = onData;
+	endHandler = onEnd;
+	handlerArg = arg;
+	state = Preamble;
+	return OK;
+}
+
+Result MultipartParser::feed(const char* data, int size) {
+	while (size > 0 && state != Done && state != Failed) {
+		int used = -1;
+		switch (state) {
+		case Preamble:
+		case PartBody:
+			used = parseBody(data, size);
+			break;
+		case AfterBoundary:
+			used = parseAfterBoundary(data, size);
+			break;
+		case PartHeaders:
+			used = parsePartHeaders(data, size);
+			break;
+		default:
+			break;
+		}
+		if (used < 0) {
+			state = Failed;
+			break;
+		}
+		data += used;
+		size -= used;
+	}
+
+	if (state == Failed) {
+		return ERROR;
+	}
+	return state == Done ? OK : MoreData;
+}
+
+int MultipartParser::find(const char* data, int size) {
+	int last = delimiterLength - 1;
+	int pos = 0;
+	while (pos + last < size) {
+		uint8_t c = data[pos + last];
+		if (c == (uint8_t)delimiter[last] && memcmp(data + pos, delimiter, last) == 0) {
+			return pos;
+		}
+		pos += skip[c];
+	}
+	return -1;
+}
+
+int MultipartParser::delimiterPrefixAtEnd(const char* data, int size) {
+	int length = size < delimiterLength - 1 ? size : delimiterLength - 1;
+	for (; length > 0; length--) {
+		if (memcmp(data + size - length, delimiter, length) == 0) {
+			break;
+		}
+	}
+	return length;
+}
+
+void MultipartParser::emit(const char* data, int size) {
+	//preamble data is dropped
+	if (state == PartBody && size > 0 && dataHandler != nullptr) {
+		dataHandler(handlerArg, data, size);
+	}
+}
+
+void MultipartParser::boundaryFound() {
+	if (state == PartBody && endHandler != nullptr) {
+		endHandler(handlerArg);
+	}
+	state = AfterBoundary;
+	afterBoundaryLength = 0;
+}
+
+int MultipartParser::parseBody(const char* data, int size) {
+	if (carryLength > 0) {
+		//a delimiter may start in the carry and end in data, look through the join
+		char window[sizeof(carry) * 2];
+		int fromData = size < delimiterLength - 1 ? size : delimiterLength - 1;
+		int carried = carryLength;
+		memcpy(window, carry, carried);
+		memcpy(window + carried, data, fromData);
+		int windowLength = carried + fromData;
+		carryLength = 0;
+
+		int pos = find(window, windowLength);
+		if (pos >= 0 && pos < carried) {
+			emit(window, pos);
+			boundaryFound();
+			return pos + delimiterLength - carried;
+		}
+		if (fromData < delimiterLength - 1) {
+			//too short to rule out yet, keep what could still be a delimiter
+			int keep = delimiterPrefixAtEnd(window, windowLength);
+			emit(window, windowLength - keep);
+			memcpy(carry, window + windowLength - keep, keep);
+			carryLength = keep;
+			return size;
+		}
+		emit(window, carried);
+	}
+
+	int pos = find(data, size);
+	if (pos >= 0) {
+		emit(data, pos);
+		boundaryFound();
+		return pos + delimiterLength;
+	}
+	int keep = delimiterPrefixAtEnd(data, size);
+	emit(data, size - keep);
+	memcpy(carry, data + size - keep, keep);
+	carryLength = keep;
+	return size;
+}
+
+int MultipartParser::parseAfterBoundary(const char* data, int size) {
+	int used = 0;
+	while (afterBoundaryLength < 2 && used < size) {
+		afterBoundary[afterBoundaryLength++] = data[used++];
+	}
+	if (afterBoundaryLength < 2) {
+		return used;
+	}
+	if (memcmp(afterBoundary, "--", 2) == 0) {
+		//the closing boundary, anything after it is ignored
+		state = Done;
+		return used;
+	}
+	if (memcmp(afterBoundary, "\r\n", 2) != 0) {
+		return -1;
+	}
+	//keep the CRLF so a part without headers ends at the same CRLFCRLF as any other
+	memcpy(partHeaders, "\r\n", 2);
+	partHeadersLength = 2;
+	state = PartHeaders;
+	return used;
+}
+
+int MultipartParser::parsePartHeaders(const char* data, int size) {
+	int before = partHeadersLength;
+	int copy = size < MaxPartHeadersSize - before ? size : MaxPartHeadersSize - before;
+	memcpy(partHeaders + before, data, copy);
+	partHeadersLength += copy;
+
+	//start far enough back to find a CRLFCRLF split across calls
+	int end = -1;
+	for (int i = before > 3 ? before - 3 : 0; i + 4 <= partHeadersLength; i++) {
+		if (memcmp(partHeaders + i, "\r\n\r\n", 4) == 0) {
+			end = i + 4;
+			break;
+		}
+	}
+	if (end < 0) {
+		return partHeadersLength == MaxPartHeadersSize ? -1 : copy;
+	}
+
+	//each line after the leading CRLF up to the blank line
+	const char* line = partHeaders + 2;
+	const char* headersEnd = partHeaders + end - 2;
+	while (line < headersEnd) {
+		auto eol = (const char*)memchr(line, '\r', headersEnd - line);
+		if (eol == nullptr) {
+			break;
+		}
+		auto colon = (const char*)memchr(line, ':', eol - line);
+		if (colon != nullptr && headerHandler != nullptr) {
+			auto value = colon + 1;
+			while (value < eol && (*value == ' ' || *value == '\t')) {
+				value++;
+			}
+			headerHandler(handlerArg, { line, (int)(colon - line) }, { value, (int)(eol - value) });
+		}
+		line = eol + 2;
+	}
+
+	state = PartBody;
+	return end - before;
+}
+
+int MultipartParser::onBodyChunk(Request* request, const char* data, int size) {
+	auto parser = static_cast<MultipartParser*>(request->getBodyHandlerArg());
+	//everything is taken even after a failure so the request still completes, check hasFailed() in the end handler
+	parser->feed(data, size);
+	return size;
+}
+
+SimpleString MultipartParser::getHeaderParam(SimpleString headerValue, const char* name) {
+	if (headerValue.value == nullptr) {
+		return { nullptr, 0 };
+	}
+	int nameLength = strlen(name);
+	const char* ptr = headerValue.value;
+	const char* end = headerValue.value + headerValue.size;
+	while (true) {
+		auto separator = (const char*)memchr(ptr, ';', end - ptr);
+		if (separator == nullptr) {
+			return { nullptr, 0 };
+		}
+		ptr = separator + 1;
+		while (ptr < end && (*ptr == ' ' || *ptr == '\t')) {
+			ptr++;
+		}
+		if (end - ptr <= nameLength || ptr[nameLength] != '=' || !Utility::equalsIgnoreCase({ ptr, nameLength }, name)) {
+			continue;
+		}
+		ptr += nameLength + 1;
+		if (ptr < end && *ptr == '"') {
+			auto quoteEnd = (const char*)memchr(ptr + 1, '"', end - ptr - 1);
+			if (quoteEnd == nullptr) {
+				return { nullptr, 0 };
+			}
+			return { ptr + 1, (int)(quoteEnd - ptr - 1) };
+		}
+		auto valueEnd = ptr;
+		while (valueEnd < end && *valueEnd != ';' && *valueEnd != ' ') {
+			valueEnd++;
+		}
+		return { ptr, (int)(valueEnd - ptr) };
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "MultipartParser.h"
+#include <string>
+#include <vector>
+using SimpleHTTP::MultipartParser;
+using SimpleHTTP::SimpleString;
+using std::string;
+
+struct Parts {
+	std::vector<string> headers;
+	std::vector<string> bodies;
+	int ended = 0;
+};
+
+static void onHeader(void* arg, SimpleString name, SimpleString value) {
+	auto parts = static_cast<Parts*>(arg);
+	parts->headers.push_back(string(name.value, name.size) + "=" + string(value.value, value.size));
+	if (parts->bodies.size() == (size_t)parts->ended) {
+		parts->bodies.push_back("");
+	}
+}
+
+static void onData(void* arg, const char* data, int size) {
+	auto parts = static_cast<Parts*>(arg);
+	parts->bodies.back().append(data, size);
+}
+
+static void onEnd(void* arg) {
+	static_cast<Parts*>(arg)->ended++;
+}
+
+static const char contentType[] = "multipart/form-data; boundary=----WebKitFormBoundary7MA4YWxkTrZu0gW";
+static const string body =
+	"preamble\r\n"
+	"------WebKitFormBoundary7MA4YWxkTrZu0gW\r\n"
+	"Content-Disposition: form-data; name=\"text\"\r\n"
+	"\r\n"
+	"hello\r\n--not a boundary\r\n"
+	"------WebKitFormBoundary7MA4YWxkTrZu0gW\r\n"
+	"Content-Disposition: form-data; name=\"file\"; filename=\"a.txt\"\r\n"
+	"Content-Type: text/plain\r\n"
+	"\r\n"
+	"\r\n------WebKitFormBoundary7MA4YWxkTrZu0g almost\r\n"
+	"------WebKitFormBoundary7MA4YWxkTrZu0gW--\r\n"
+	"epilogue";
+
+TEST(MultipartParser, AnySplit) {
+	//every chunk size so the boundary, the CRLFs and the headers are split at each position
+	for (int chunk = 1; chunk <= (int)body.size(); chunk++) {
+		Parts parts;
+		MultipartParser parser;
+		ASSERT_EQ(parser.begin({ contentType, (int)sizeof(contentType) - 1 }, onHeader, onData, onEnd, &parts), SimpleHTTP::OK);
+		SimpleHTTP::Result result = SimpleHTTP::MoreData;
+		for (int pos = 0; pos < (int)body.size(); pos += chunk) {
+			int size = std::min(chunk, (int)body.size() - pos);
+			result = parser.feed(body.data() + pos, size);
+		}
+		ASSERT_EQ(result, SimpleHTTP::OK) << "chunk " << chunk;
+		ASSERT_EQ(parts.ended, 2) << "chunk " << chunk;
+		ASSERT_EQ(parts.headers.size(), 3u);
+		ASSERT_EQ(parts.headers[0], "Content-Disposition=form-data; name=\"text\"");
+		ASSERT_EQ(parts.headers[2], "Content-Type=text/plain");
+		ASSERT_EQ(parts.bodies[0], "hello\r\n--not a boundary") << "chunk " << chunk;
+		ASSERT_EQ(parts.bodies[1], "\r\n------WebKitFormBoundary7MA4YWxkTrZu0g almost") << "chunk " << chunk;
+	}
+}
+
+TEST(MultipartParser, HeaderParams) {
+	const char disposition[] = "form-data; name=\"file\"; filename=\"a b.txt\"";
+	auto name = MultipartParser::getHeaderParam({ disposition, (int)sizeof(disposition) - 1 }, "name");
+	ASSERT_EQ(string(name.value, name.size), "file");
+	auto filename = MultipartParser::getHeaderParam({ disposition, (int)sizeof(disposition) - 1 }, "filename");
+	ASSERT_EQ(string(filename.value, filename.size), "a b.txt");
+	ASSERT_EQ(MultipartParser::getHeaderParam({ disposition, (int)sizeof(disposition) - 1 }, "size").value, nullptr);
+
+	MultipartParser parser;
+	const char notMultipart[] = "application/json";
+	ASSERT_EQ(parser.begin({ notMultipart, (int)sizeof(notMultipart) - 1 }, onHeader, onData, onEnd, nullptr), SimpleHTTP::ERROR);
+}
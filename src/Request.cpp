@@ -18,20 +18,44 @@
  *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Request.h"
+#include "utility.h"
+#include "DelimiterScanner.h"
 #include <string.h>
 #include <ctype.h>
+#include <algorithm>
+#include <tuple>
 using namespace SimpleHTTP;
 
-Request::Request() {
+Request::Request() :
+	requestBuffer(ArenaAllocator<char>(&arena)),
+	pipelined(ArenaAllocator<char>(&arena)),
+	query(ArenaAllocator<char>(&arena)),
+#if !SIMPLE_HTTP_ZERO_COPY_HEADERS
+	headers(ArenaStringMap::allocator_type(&arena)),
+#endif
+	path(ArenaAllocator<char>(&arena)) {
 	reset();
 }
 
 Result Request::parse(char* data, int length) {
-	if (lastResult == MoreData) {
+	if (parsingStage == WaitingComplete) {
+		//the client didn't wait for the response, keep it until next()
+		return keepPipelined(data, length);
+	}
+	if (bodyStreaming) {
+		return streamBody(data, length);
+	}
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+	//headers are kept as offsets in to requestBuffer so everything is buffered
+	const bool buffered = true;
+#else
+	const bool buffered = lastResult == MoreData;
+#endif
+	if (buffered) {
 		if (appendToBuffer(data, length) == ERROR) {
 			return ERROR;
 		}
-		data = &requestBuffer[bufferReadPos];
+		data = requestBuffer.data() + bufferReadPos;
 		length = requestBuffer.size() - bufferReadPos;
 	}
 
@@ -40,75 +64,107 @@ Result Request::parse(char* data, int length) {
 	switch (parsingStage) {
 	case WaitingRequestLine:
 	{
-		auto strMethod = nextToken({ data,length }, SpaceChar);
-
-		if (strMethod.size == 0) {
+		//method SP path SP version, found with one pass over the line
+		DelimiterScanner::Line line;
+		DelimiterScanner::scanLine(data, dataEndPtr, &line);
+		if (line.eol == nullptr) {
 			goto moreData;
 		}
-		auto m = parseMethod(strMethod);
-		if (m == UnknownMethod) {
+		if (line.firstSpace == nullptr || line.lastSpace - line.firstSpace < 2) {
 			return ERROR;
 		}
 
-		char* resetToPos = data;
-		data += strMethod.size + 1;
-
-
-		auto strPath = nextToken({ data,(int)(dataEndPtr - data) }, SpaceChar);
-		if (strPath.size == 0) {
-			data = resetToPos;
-			goto moreData;
+		auto m = parseMethod({ data,(int)(line.firstSpace - data) });
+		if (m == UnknownMethod) {
+			return ERROR;
 		}
 
-		data += strPath.size + 1;
-
-		auto strHTTPVersion = nextEOL({ data,(int)(dataEndPtr - data) }, &data);
-		if (strHTTPVersion.size == 0) {
-			data = resetToPos;
-			goto moreData;
+		SimpleString strPath = { line.firstSpace + 1,(int)(line.lastSpace - line.firstSpace - 1) };
+		const char* versionEnd = line.eol;
+		if (versionEnd > line.lastSpace + 1 && versionEnd[-1] == '\r') {
+			versionEnd--;
 		}
-		auto httpVersion = parseHTTPVersion({ strHTTPVersion.value,strHTTPVersion.size });
+		auto httpVersion = parseHTTPVersion({ line.lastSpace + 1,(int)(versionEnd - line.lastSpace - 1) });
 		if (httpVersion == Error) {
 			return ERROR;
 		}
 		else if (httpVersion == VersionUnknown) {
 			goto moreData;
 		}
+		data = (char*)line.eol + 1;
 
 		method = m;
 		version = httpVersion;
-		path.assign(strPath.value, strPath.size);
+		auto queryStart = (const char*)memchr(strPath.value, '?', strPath.size);
+		if (queryStart != nullptr) {
+			int pathSize = queryStart - strPath.value;
+			query.assign(queryStart + 1, strPath.size - pathSize - 1);
+			path.assign(strPath.value, pathSize);
+		}
+		else {
+			path.assign(strPath.value, strPath.size);
+		}
 		parsingStage = WaitingHeaders;
 
 	}
 	case WaitingHeaders:
 	{
-		int contentLength = 0;
-		char* start = data;
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+		if (requestBuffer.size() > UINT16_MAX) {
+			return ERROR;
+		}
+#endif
 		while (true) {
-			auto header = parseHeaderLine({ data,(int)(dataEndPtr - data) }, &data);
+			auto header = parseHeaderLineView({ data,(int)(dataEndPtr - data) }, &data);
 			if (header.name.size == 0) {
 				break;
 			}
-			string headerName(header.name.value, header.name.size);
-			int length = headerName.size();
-
-			for (int i = 0; i < length; i++) {
-				headerName[i] = toupper(headerName[i]);
+			if (header.name.size > MaxHeaderNameLength) {
+				return ERROR;
+			}
+			auto id = HeaderIds::find(header.name.value, header.name.size);
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+			//too many to keep, the request is rejected rather than silently missing headers
+			if (headerCount == SIMPLE_HTTP_MAX_HEADERS) {
+				return ERROR;
+			}
+			if (id != HeaderId::Unknown) {
+				knownHeaders[(int)id] = headerCount;
+			}
+			headerOffsets[headerCount++] = {
+				(uint16_t)(header.name.value - requestBuffer.data()), (uint16_t)header.name.size,
+				(uint16_t)(header.value.value - requestBuffer.data()), (uint16_t)header.value.size
+			};
+#else
+			//upper cased on the stack so the key in the map is the only copy in the arena
+			char headerName[MaxHeaderNameLength];
+			for (int i = 0; i < header.name.size; i++) {
+				headerName[i] = toupper(header.name.value[i]);
 			}
 
-			headers[headerName] = header.value;
+			auto& value = headers.emplace(std::piecewise_construct,
+				std::forward_as_tuple(headerName, (size_t)header.name.size), std::forward_as_tuple()).first->second;
+			value.assign(header.value.value, header.value.size);
+			if (id != HeaderId::Unknown) {
+				knownHeaders[(int)id] = &value;
+			}
+#endif
 			//if there is a body gather some info on how it's encoded
 			if (methodHasBody[method]) {
-				if (headerName == ContentLengthHeaderName) {
-					bodyLength = std::stoi(header.value);
-
+				if (id == HeaderId::ContentLength) {
+					bodyLength = parseContentLength(header.value);
+					if (bodyLength < 0) {
+						return ERROR;
+					}
 				}
-				else if (headerName == TransferEncodingHeaderName) {
-					if (header.value == "Chunked" || header.value == "chunked") {
+				else if (id == HeaderId::TransferEncoding) {
+					if (Utility::equalsIgnoreCase(header.value, "chunked")) {
 						bodyEncodingChunked = true;
 					}
 				}
+				else if (id == HeaderId::Expect) {
+					expectContinue = version == HTTP11 && Utility::equalsIgnoreCase(header.value, "100-continue");
+				}
 			}
 
 		}
@@ -116,17 +172,26 @@ Result Request::parse(char* data, int length) {
 		if (endOfHeaders) {
 			data += endOfHeaders;
 			parsingStage = WaitingBody;
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+			headersSize = data - requestBuffer.data();
+#endif
 		}
 		else {
-			data = start;
+			//data is after the last complete header line, the next call resumes from there
 			goto moreData;
 		}
 	}
 	case WaitingBody:
 	{
-		if (!methodHasBody[method]) {
+		if (!methodHasBody[method] || bodyComplete || (!bodyEncodingChunked && bodyLength == 0)) {
+			//no body or all of it has been read, anything else is the next request
 			parsingStage = WaitingComplete;
-			return OK;
+			auto result = keepPipelined(data, dataEndPtr - data);
+			if (buffered) {
+				//moved, so next() doesn't find it in requestBuffer as well
+				requestBuffer.resize(data - requestBuffer.data());
+			}
+			return result;
 		}
 
 		if (bodyEncodingChunked || bodyLength != 0) {
@@ -141,7 +206,7 @@ Result Request::parse(char* data, int length) {
 
 	return ERROR;
 moreData:
-	if (lastResult == MoreData) {
+	if (buffered) {
 		bufferReadPos = data - requestBuffer.data();
 
 	}
@@ -155,11 +220,156 @@ moreData:
 
 }
 
+Result Request::next() {
+	//what's left of this request's buffer goes ahead of anything received after it
+	if (bodyComplete && getBodyBuffered() > 0) {
+		pipelined.insert(pipelined.begin(), requestBuffer.begin() + bufferReadPos, requestBuffer.end());
+	}
+	int held = pipelinedHeld;
+	ArenaBuffer pending(pipelined.get_allocator());
+	pending.swap(pipelined);
+	reset();
+	int size = pending.size();
+	if (size == 0) {
+		return OK;
+	}
+	//kept at the start of the arena rather than copied, heap fallbacks stay where they are until parsed
+	char* data = pending.data();
+	if (arena.owns(data)) {
+		data = (char*)arena.keep(data, size);
+		ArenaBuffer(pending.get_allocator()).swap(pending);
+	}
+	auto result = parse(data, size);
+	//only the newest bytes were held, they are the ones still pipelined
+	if (pipelinedHeld > held) {
+		pipelinedHeld = held;
+	}
+	return result;
+}
+
+Result Request::keepPipelined(const char* data, int size) {
+	if (size == 0) {
+		return OK;
+	}
+	if (pipelined.empty()) {
+		//all at once so growing it doesn't leave blocks behind in the arena
+		pipelined.reserve(SIMPLE_HTTP_MAX_PIPELINED_SIZE);
+	}
+	pipelined.insert(pipelined.end(), data, data + size);
+	int over = (int)pipelined.size() - SIMPLE_HTTP_MAX_PIPELINED_SIZE;
+	if (over > 0) {
+		pipelinedHeld += over < size ? over : size;
+	}
+	return OK;
+}
+
+bool Request::setBodyHandler(BodyChunkHandler onChunk, BodyEndHandler onEnd, void* arg) {
+	if (parsingStage != WaitingBody || bodyEncodingChunked || bodyLength == 0 || bodyReadInProgress || onChunk == nullptr) {
+		return false;
+	}
+	bodyChunkHandler = onChunk;
+	bodyEndHandler = onEnd;
+	bodyHandlerArg = arg;
+	bodyReadInProgress = true;
+	return true;
+}
+
+void Request::beginBodyStream() {
+	bodyStreaming = true;
+	//anything after the body belongs to the next request
+	int waiting = getBodyBuffered();
+	if (waiting > bodyLength) {
+		//already received so not held, data received after it is once over the limit
+		keepPipelined(requestBuffer.data() + bufferReadPos + bodyLength, waiting - bodyLength);
+		pipelinedHeld = 0;
+		requestBuffer.resize(bufferReadPos + bodyLength);
+		waiting = bodyLength;
+	}
+	bodyLength -= waiting;
+	deliverBufferedBody();
+}
+
+int Request::offerBody(const char* data, int size) {
+	int used = bodyChunkHandler(this, data, size);
+	if (used < 0) {
+		return 0;
+	}
+	return used > size ? size : used;
+}
+
+int Request::deliverBufferedBody() {
+	int waiting = getBodyBuffered();
+	int used = 0;
+	//until it's all taken or the handler stops taking it
+	while (used < waiting) {
+		int taken = offerBody(requestBuffer.data() + bufferReadPos + used, waiting - used);
+		if (taken == 0) {
+			break;
+		}
+		used += taken;
+	}
+	bufferReadPos += used;
+	//held bytes are at the end of the buffer so they are only released once the ones before them are used
+	int released = used - (waiting - bodyHeld);
+	if (released > 0) {
+		bodyHeld -= released;
+	}
+	if (getBodyBuffered() == 0) {
+		resetBuffer();
+		if (bodyLength == 0) {
+			parsingStage = WaitingComplete;
+		}
+	}
+	return used;
+}
+
+Result Request::streamBody(char* data, int length) {
+	//older data goes first, new data waits behind it if that isn't all taken
+	deliverBufferedBody();
+
+	int size = length < bodyLength ? length : bodyLength;
+	bodyLength -= size;
+	int used = size > 0 && getBodyBuffered() == 0 ? offerBody(data, size) : 0;
+	if (used < size) {
+		appendToBuffer(data + used, size - used);
+		bodyHeld += size - used;
+	}
+	if (keepPipelined(data + size, length - size) == ERROR) {
+		return ERROR;
+	}
+
+	if (bodyLength == 0 && getBodyBuffered() == 0) {
+		resetBuffer();
+		parsingStage = WaitingComplete;
+		return OK;
+	}
+	return MoreData;
+}
+
+void Request::endBody(Response* response) {
+	bodyReadInProgress = false;
+	if (bodyEndHandler != nullptr) {
+		bodyEndHandler(this, response);
+	}
+}
+
 Result  Request::appendToBuffer(char* data, int size) {
+	size_t needed = requestBuffer.size() + size;
+	if (needed > requestBuffer.capacity()) {
+		//grown in large steps as the arena can't reuse the block given up by each one
+		requestBuffer.reserve(std::max(needed, std::max((size_t)requestBufferSize, requestBuffer.capacity() * 2)));
+	}
 	requestBuffer.insert(requestBuffer.end(), data, data + size);
 	return MoreData;
 }
 
+SimpleString Request::methodName(Method m) {
+	if (m < 0 || m >= requestMethodsCount) {
+		return { nullptr, 0 };
+	}
+	return { requestMethods[m].value, requestMethods[m].size };
+}
+
 Request::Method Request::parseMethod(SimpleString strMethod) {
 	for (int i = 0; i < requestMethodsCount; i++) {
 		if (strMethod.size == requestMethods[i].size && memcmp(strMethod.value, requestMethods[i].value, strMethod.size) == 0) {
@@ -179,48 +389,94 @@ HTTPVersion Request::parseHTTPVersion(SimpleString str) {
 }
 
 HTTPHeader Request::parseHeaderLine(SimpleString data, char** eolEndPosPtr) {
-
-	SimpleString headerName = nextToken(data, ':');
-	if (headerName.size == 0) {
+	auto header = parseHeaderLineView(data, eolEndPosPtr);
+	if (header.name.size == 0) {
 		return { 0 };
 	}
+	return { header.name,string(header.value.value,header.value.size) };
+}
 
-	int offset = headerName.size + 2;
-	if (offset >= data.size) {
-		return { 0 };
+HTTPHeaderView Request::parseHeaderLineView(SimpleString data, char** eolEndPosPtr) {
+	//name:value, found with one pass over the line
+	DelimiterScanner::Line line;
+	DelimiterScanner::scanLine(data.value, data.value + data.size, &line);
+	if (line.eol == nullptr || line.colon == nullptr || line.colon == data.value) {
+		return { { 0 }, { 0 } };
 	}
 
-	auto value = nextEOL({ data.value + offset,data.size - offset }, eolEndPosPtr);
-
-	if (value.value == 0) {
-		return { 0 };
+	//optional white space either side of the value
+	const char* value = line.colon + 1;
+	const char* valueEnd = line.eol;
+	while (value < valueEnd && (*value == ' ' || *value == '\t')) {
+		value++;
 	}
+	while (valueEnd > value && (valueEnd[-1] == '\r' || valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) {
+		valueEnd--;
+	}
+	*eolEndPosPtr = (char*)line.eol + 1;
 
-	return { headerName,string(value.value,value.size) };
-
+	return { { data.value,(int)(line.colon - data.value) }, { value,(int)(valueEnd - value) } };
 }
 
-SimpleString Request::nextToken(SimpleString data, char tok) {
-	char* ptr = (char*)memchr(data.value, tok, data.size);
-	if (ptr == 0) {
-		return {};
+int Request::parseContentLength(SimpleString value) {
+	if (value.size == 0 || value.size > 9) {
+		return -1;
 	}
-	return { data.value,(int)(ptr - data.value) };
+	int length = 0;
+	for (int i = 0; i < value.size; i++) {
+		if (value.value[i] < '0' || value.value[i] > '9') {
+			return -1;
+		}
+		length = length * 10 + (value.value[i] - '0');
+	}
+	return length;
 }
 
-SimpleString Request::nextEOL(SimpleString line, char** eolEndPosPtr) {
-	char* ptr = (char*)memchr(line.value, '\n', line.size);
-	if (ptr == 0) {
-		return {};
+SimpleString Request::header(HeaderId id) {
+	if (id >= HeaderId::Count) {
+		return { nullptr, 0 };
 	}
-
-	*eolEndPosPtr = ptr + 1;
-
-	if (ptr - line.value > 0 && *(ptr - 1) == '\r') {
-		ptr--;
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+	int index = knownHeaders[(int)id];
+	if (index < 0) {
+		return { nullptr, 0 };
 	}
+	auto& h = headerOffsets[index];
+	return { requestBuffer.data() + h.valueOffset, h.valueLength };
+#else
+	auto value = knownHeaders[(int)id];
+	if (value == nullptr) {
+		return { nullptr, 0 };
+	}
+	return { value->data(), (int)value->size() };
+#endif
+}
 
-	return { line.value,(int)(ptr - line.value) };
+SimpleString Request::getHeader(const char* name) {
+	auto id = HeaderIds::find(name, strlen(name));
+	if (id != HeaderId::Unknown) {
+		return header(id);
+	}
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+	const char* base = requestBuffer.data();
+	for (int i = 0; i < headerCount; i++) {
+		auto& h = headerOffsets[i];
+		if (Utility::equalsIgnoreCase({ base + h.nameOffset, h.nameLength }, name)) {
+			return { base + h.valueOffset, h.valueLength };
+		}
+	}
+	return { nullptr, 0 };
+#else
+	ArenaString key(name);
+	for (auto& c : key) {
+		c = toupper(c);
+	}
+	auto header = headers.find(key);
+	if (header == headers.end()) {
+		return { nullptr, 0 };
+	}
+	return { header->second.data(), (int)header->second.size() };
+#endif
 }
 
 int Request::isEOL(SimpleString line) {
@@ -237,89 +493,65 @@ int Request::isEOL(SimpleString line) {
 	return 0;
 }
 
-bool Request::isEndOfChunkedBodyMarker(SimpleString line) {
-	if (line.size >= 5) {
-		if (memcmp(line.value, "0\r\n\r\n", 2) == 0) {
-			return true;
-		}
-	}
-	return false;
-}
-
 Result Request::readBody(char* dstBuffer, int* dstBufferSize) {
-	int outputBufferSize = *dstBufferSize;
-	int outputBytesWritten = 0;
-	bool atEndOfBuffer = false;
-	bodyReadInProgress = true;
-
-	char* requestBufferReadPos = &requestBuffer[bufferReadPos];
-	const char* requestBufferEnd = requestBuffer.data() + requestBuffer.size();
-
-	//if the body is chunked it should start with the chunk size in hex followed by a new line
-
+	if (bodyEncodingChunked) {
+		return readChunkedBody(dstBuffer, dstBufferSize);
+	}
 	if (bodyLength == 0) {
-		if (!bodyEncodingChunked) {
-			return ERROR;
-		}
-	tryReadNextChunk:
-		auto strChunkSize = nextEOL({ requestBufferReadPos,(int)(requestBuffer.size()) }, &requestBufferReadPos);
-		if (strChunkSize.value == nullptr) {
-			return MoreData;
-		}
-
-		bodyLength = std::stoi(string(strChunkSize.value, strChunkSize.size), 0, 16);
-		if (bodyLength == 0 && isEOL({ requestBufferReadPos,(int)(requestBuffer.size()) })) {
-			*dstBufferSize = outputBytesWritten;
-			lastBodyOutputBytesWritten = outputBytesWritten;
-			bodyReadInProgress = false;
-			bufferReadPos = requestBufferEnd - requestBufferReadPos;
-			return OK;
-		}
+		return ERROR;
 	}
+	bodyReadInProgress = true;
 
-	if (bodyLength != 0) {
-		int sizeToCopy = bodyLength;
-		int dataInRequestBuffer = requestBufferEnd - requestBufferReadPos;
-		if (sizeToCopy >= dataInRequestBuffer) {
-			sizeToCopy = dataInRequestBuffer;
-			atEndOfBuffer = true;
-		}
-
-		int spaceInDstBuffer = outputBufferSize;
-		if (sizeToCopy >= spaceInDstBuffer) {
-			sizeToCopy = spaceInDstBuffer;
-		}
-
-		memcpy(dstBuffer, requestBufferReadPos, sizeToCopy);
-		requestBufferReadPos += sizeToCopy;
-		bodyLength -= sizeToCopy;
-		outputBytesWritten += sizeToCopy;
-		*dstBufferSize = outputBytesWritten;
-		lastBodyOutputBytesWritten = outputBytesWritten;
-
-		if (bodyLength == 0 && bodyEncodingChunked) {
-			nextEOL({ requestBufferReadPos,(int)(requestBuffer.size()) }, &requestBufferReadPos);
-			goto tryReadNextChunk;
-		}
+	int sizeToCopy = bodyLength;
+	if (sizeToCopy > getBodyBuffered()) {
+		sizeToCopy = getBodyBuffered();
+	}
+	if (sizeToCopy > *dstBufferSize) {
+		sizeToCopy = *dstBufferSize;
 	}
 
-	if (atEndOfBuffer) {
+	memcpy(dstBuffer, requestBuffer.data() + bufferReadPos, sizeToCopy);
+	//position not remaining count, unReadBody() steps back from here
+	bufferReadPos += sizeToCopy;
+	bodyLength -= sizeToCopy;
+	*dstBufferSize = sizeToCopy;
+	lastBodyOutputBytesWritten = sizeToCopy;
+
+	if (getBodyBuffered() == 0) {
 		resetBuffer();
 	}
 
-	bufferReadPos = requestBufferEnd - requestBufferReadPos;
-
 	if (bodyLength == 0) {
 		bodyReadInProgress = false;
+		bodyComplete = true;
 		return OK;
 	}
-	else {
-		return MoreData;
+	return MoreData;
+}
+
+Result Request::readChunkedBody(char* dstBuffer, int* dstBufferSize) {
+	if (bodyComplete) {
+		return ERROR;
 	}
+	bodyReadInProgress = true;
+	lastBodyOutputBytesWritten = 0;
+
+	int consumed = getBodyBuffered();
+	auto result = chunkedDecoder.decode(requestBuffer.data() + bufferReadPos, &consumed, dstBuffer, dstBufferSize);
+	bufferReadPos += consumed;
+	if (result == OK) {
+		//anything left is the next request
+		bodyReadInProgress = false;
+		bodyComplete = true;
+	}
+	else if (getBodyBuffered() == 0) {
+		resetBuffer();
+	}
+	return result;
 }
 
 Result Request::unReadBody() {
-	if (bufferReadPos - lastBodyOutputBytesWritten <= 0) {
+	if (bodyEncodingChunked || bufferReadPos - lastBodyOutputBytesWritten <= 0) {
 		return ERROR;
 	}
 	bufferReadPos -= lastBodyOutputBytesWritten;
@@ -327,18 +559,77 @@ Result Request::unReadBody() {
 	return OK;
 }
 
+SimpleString Request::getPathParam(const char* name) {
+	for (int i = 0; i < pathParamCount; i++) {
+		if (strcmp(pathParams[i].name, name) == 0) {
+			return { path.data() + pathParams[i].offset, pathParams[i].length };
+		}
+	}
+	return { nullptr, 0 };
+}
+
+FormFields& Request::getQuery() {
+	if (!queryParsed) {
+		queryFields.parse(query.data(), query.size());
+		queryParsed = true;
+	}
+	return queryFields;
+}
+
+Result Request::readForm(FormFields* form) {
+	if (parsingStage != WaitingBody || bodyEncodingChunked || bodyStreaming || bodyLength == 0 || bodyLength > UINT16_MAX) {
+		return ERROR;
+	}
+	bodyReadInProgress = true;
+	if (getBodyBuffered() < bodyLength) {
+		return MoreData;
+	}
+	form->parse(requestBuffer.data() + bufferReadPos, bodyLength);
+	bufferReadPos += bodyLength;
+	bodyLength = 0;
+	bodyReadInProgress = false;
+	bodyComplete = true;
+	//anything received from now on is kept for next() so requestBuffer doesn't move under the fields
+	parsingStage = WaitingComplete;
+	return OK;
+}
+
 void Request::reset() {
 	version = VersionUnknown;
 	method = UnknownMethod;
 	parsingStage = WaitingRequestLine;
 	lastResult = Result::OK;
-	requestBuffer.clear();
+	bufferReadPos = 0;
 	bodyEncodingChunked = false;
+	chunkedDecoder.reset();
 	bodyReadInProgress = false;
+	bodyComplete = false;
+	bodyChunkHandler = nullptr;
+	bodyEndHandler = nullptr;
+	bodyHandlerArg = nullptr;
+	bodyStreaming = false;
+	bodyHeld = 0;
+	pipelinedHeld = 0;
+	expectContinue = false;
+	continueSent = false;
 	hasMoreBodyDataSinceLastCheck = false;
 	lastBodyOutputBytesWritten = 0;
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+	headerCount = 0;
+	headersSize = 0;
+	memset(knownHeaders, -1, sizeof(knownHeaders));
+#else
 	headers.clear();
-	path.clear();
+	memset(knownHeaders, 0, sizeof(knownHeaders));
+#endif
+	//swapped rather than cleared so nothing keeps capacity in the arena, only heap fallbacks are freed here
+	ArenaBuffer(requestBuffer.get_allocator()).swap(requestBuffer);
+	ArenaString(path.get_allocator()).swap(path);
+	ArenaString(query.get_allocator()).swap(query);
+	ArenaBuffer(pipelined.get_allocator()).swap(pipelined);
+	queryParsed = false;
+	arena.reset();
+	pathParamCount = 0;
 	bodyLength = 0;
 }
 
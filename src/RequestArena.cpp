@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RequestArena.h"
+#include <new>
+#include <string.h>
+using namespace SimpleHTTP;
+
+std::atomic<uint32_t> RequestArena::heapFallbacks(0);
+
+void* RequestArena::allocate(size_t size, size_t alignment) {
+	size_t start = (used + alignment - 1) & ~(alignment - 1);
+	if (Size > 0 && start + size <= Size) {
+		lastAllocation = start;
+		used = start + size;
+		return buffer + start;
+	}
+	if (Size > 0) {
+		heapFallbacks++;
+	}
+	return ::operator new(size);
+}
+
+void RequestArena::deallocate(void* ptr, size_t size) {
+	if (!owns(ptr)) {
+		::operator delete(ptr);
+		return;
+	}
+	//i.e. a temporary string
+	if ((char*)ptr == buffer + lastAllocation && lastAllocation + size == used) {
+		used = lastAllocation;
+	}
+}
+
+void* RequestArena::keep(const void* data, size_t size) {
+	memmove(buffer, data, size);
+	used = size;
+	//an empty last allocation so a stale pointer given to deallocate() can't free the kept bytes
+	lastAllocation = used;
+	return buffer;
+}
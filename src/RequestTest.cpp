@@ -22,6 +22,7 @@
 using SimpleHTTPTest::RequestTest;
 using SimpleHTTP::SimpleString;
 #include "gtest/gtest.h"
+#include "DelimiterScanner.h"
 #include <string.h>
 using namespace SimpleHTTP;
 
@@ -71,7 +72,10 @@ TEST(Request, fullRequestGET) {
 	auto result = r.parse((char*)req.c_str(),req.length());
 	GTEST_ASSERT_EQ(result, Result::OK);
 	GTEST_ASSERT_EQ(r.method, Request::GET);
+#if !SIMPLE_HTTP_ZERO_COPY_HEADERS
 	GTEST_ASSERT_EQ(r.headers["HOST"], "hello");
+#endif
+	GTEST_ASSERT_EQ(string(r.getHeader("host").value, r.getHeader("host").size), "hello");
 	GTEST_ASSERT_EQ(r.path, "/abc");
 }
 
@@ -83,10 +87,430 @@ TEST(Request, requestGET) {
 	while (r.parse((char*)strRequest, 1) == MoreData) strRequest++;
 	//GTEST_ASSERT_EQ(result, Result::OK);
 	GTEST_ASSERT_EQ(r.method, Request::GET);
+#if !SIMPLE_HTTP_ZERO_COPY_HEADERS
 	GTEST_ASSERT_EQ(r.headers["HOST"], "hello");
+#endif
+	GTEST_ASSERT_EQ(string(r.getHeader("host").value, r.getHeader("host").size), "hello");
 	GTEST_ASSERT_EQ(r.path, "/abc");
 }
 
+TEST(Request, wellKnownHeaders) {
+	Request r;
+	string req("GET /abc HTTP/1.1\r\nHOST: hello\r\nx-custom: 1\r\nsec-websocket-key: abc\r\n\r\n");
+	auto result = r.parse((char*)req.c_str(), req.length());
+	GTEST_ASSERT_EQ(result, Result::OK);
+	GTEST_ASSERT_EQ(HeaderIds::find("Sec-WebSocket-Key", 17), HeaderId::SecWebSocketKey);
+	GTEST_ASSERT_EQ(HeaderIds::find("X-Custom", 8), HeaderId::Unknown);
+	GTEST_ASSERT_EQ(string(r.header(HeaderId::Host).value, r.header(HeaderId::Host).size), "hello");
+	GTEST_ASSERT_EQ(string(r.header(HeaderId::SecWebSocketKey).value, r.header(HeaderId::SecWebSocketKey).size), "abc");
+	GTEST_ASSERT_EQ(r.header(HeaderId::Connection).value, nullptr);
+	GTEST_ASSERT_EQ(string(r.getHeader("X-Custom").value, r.getHeader("X-Custom").size), "1");
+}
+
+#if SIMPLE_HTTP_ZERO_COPY_HEADERS
+TEST(Request, headerLimit) {
+	string headers;
+	for (int i = 0; i < SIMPLE_HTTP_MAX_HEADERS; i++) {
+		headers += "X-" + std::to_string(i) + ": v\r\n";
+	}
+	Request atLimit;
+	string req = "GET / HTTP/1.1\r\n" + headers + "\r\n";
+	GTEST_ASSERT_EQ(atLimit.parse((char*)req.c_str(), req.length()), Result::OK);
+
+	Request overLimit;
+	req = "GET / HTTP/1.1\r\n" + headers + "Host: a\r\n\r\n";
+	GTEST_ASSERT_EQ(overLimit.parse((char*)req.c_str(), req.length()), Result::ERROR);
+}
+#endif
+
+static void expectLine(const string& str, const DelimiterScanner::Line& line, int firstSpace, int lastSpace, int colon, int eol) {
+	auto offset = [&](const char* ptr) { return ptr == nullptr ? -1 : (int)(ptr - str.data()); };
+	GTEST_ASSERT_EQ(offset(line.firstSpace), firstSpace);
+	GTEST_ASSERT_EQ(offset(line.lastSpace), lastSpace);
+	GTEST_ASSERT_EQ(offset(line.colon), colon);
+	GTEST_ASSERT_EQ(offset(line.eol), eol);
+}
+
+TEST(Request, delimiterScanner) {
+	DelimiterScanner::Line line;
+	string requestLine("GET /a/long/enough/path?to=cross&a=block HTTP/1.1\r\nHost: x\r\n");
+	DelimiterScanner::scanLine(requestLine.data(), requestLine.data() + requestLine.size(), &line);
+	expectLine(requestLine, line, 3, 40, -1, 50);
+
+	//nothing after the end of the line is recorded
+	string header("Content-Type: text/plain\r\nHost: x:1 y\r\n");
+	DelimiterScanner::scanLine(header.data(), header.data() + header.size(), &line);
+	expectLine(header, line, 13, 13, 12, 25);
+
+	//each delimiter in each position across the vector block sizes and the byte loop tail, against the byte loop
+	const char delimiters[] = { ' ', ':', '\n' };
+	for (int length = 0; length < 50; length++) {
+		for (int first = 0; first < length; first++) {
+			for (int second = first; second < length; second++) {
+				for (char a : delimiters) {
+					for (char b : delimiters) {
+						string str(length, 'a');
+						str[first] = a;
+						str[second] = b;
+						DelimiterScanner::Line expected;
+						DelimiterScanner::scanLineBytes(str.data(), str.data() + str.size(), &expected);
+						DelimiterScanner::scanLine(str.data(), str.data() + str.size(), &line);
+						expectLine(str, line, expected.firstSpace == nullptr ? -1 : expected.firstSpace - str.data(),
+							expected.lastSpace == nullptr ? -1 : expected.lastSpace - str.data(),
+							expected.colon == nullptr ? -1 : expected.colon - str.data(),
+							expected.eol == nullptr ? -1 : expected.eol - str.data());
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(Request, headerValueWhiteSpace) {
+	Request r;
+	string req("GET / HTTP/1.1\r\nHost:hello\r\nX-A: \t spaced \r\nX-B:\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+	GTEST_ASSERT_EQ(string(r.getHeader("Host").value, r.getHeader("Host").size), "hello");
+	GTEST_ASSERT_EQ(string(r.getHeader("X-A").value, r.getHeader("X-A").size), "spaced");
+	GTEST_ASSERT_EQ(r.getHeader("X-B").size, 0);
+}
+
+TEST(Request, badRequestLine) {
+	Request r;
+	string req("GET /\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::ERROR);
+}
+
+TEST(Request, bodyIsNotParsedAsHeader) {
+	Request r;
+	string req("POST /abc HTTP/1.1\r\nHost: hello\r\nContent-Length: 6\r\n\r\na: b\r\n");
+	auto result = r.parse((char*)req.c_str(), req.length());
+	GTEST_ASSERT_EQ(result, Result::MoreData);
+
+	char buffer[20] = "";
+	int size = sizeof(buffer);
+	GTEST_ASSERT_EQ(r.readBody(buffer, &size), Result::OK);
+	GTEST_ASSERT_EQ(string(buffer, size), "a: b\r\n");
+}
+
+TEST(Request, headersAcrossSeveralCalls) {
+	Request r;
+	string req("POST /abc HTTP/1.1\r\nHost: hello\r\nContent-Length: 2\r\nX-A: 1\r\nX-B: 22\r\n\r\nok");
+	const char* strRequest = req.c_str();
+	const char* end = strRequest + req.length();
+	int i = 0;
+	//uneven pieces so calls end both mid line and on line boundaries
+	while (strRequest < end) {
+		int size = std::min((int)(end - strRequest), 1 + (i++ % 7));
+		r.parse((char*)strRequest, size);
+		strRequest += size;
+	}
+	GTEST_ASSERT_EQ(r.receivedAllHeaders(), true);
+	GTEST_ASSERT_EQ(r.getBodyLength(), 2);
+	GTEST_ASSERT_EQ(string(r.getHeader("host").value, r.getHeader("host").size), "hello");
+	GTEST_ASSERT_EQ(string(r.getHeader("x-a").value, r.getHeader("x-a").size), "1");
+	GTEST_ASSERT_EQ(string(r.getHeader("x-b").value, r.getHeader("x-b").size), "22");
+
+	char buffer[20] = "";
+	int size = sizeof(buffer);
+	GTEST_ASSERT_EQ(r.readBody(buffer, &size), Result::OK);
+	GTEST_ASSERT_EQ(string(buffer, size), "ok");
+}
+
+#if SIMPLE_HTTP_REQUEST_ARENA_SIZE > 0
+TEST(Request, arenaFallsBackToHeap) {
+	RequestArena arena;
+	uint32_t fallbacks = RequestArena::getHeapFallbackCount();
+	void* first = arena.allocate(16, 8);
+	GTEST_ASSERT_EQ(arena.getUsed(), 16);
+	//the latest allocation can be given back
+	arena.deallocate(first, 16);
+	GTEST_ASSERT_EQ(arena.getUsed(), 0);
+
+	void* all = arena.allocate(RequestArena::Size, 1);
+	void* heap = arena.allocate(8, 8);
+	GTEST_ASSERT_EQ(RequestArena::getHeapFallbackCount(), fallbacks + 1);
+	arena.deallocate(heap, 8);
+	arena.deallocate(all, RequestArena::Size);
+
+	arena.reset();
+	GTEST_ASSERT_EQ(arena.allocate(8, 8), first);
+}
+#endif
+
+//a typical browser request, 407 bytes
+static const string browserRequest = "GET /index.shtml HTTP/1.1\r\nHost: 192.168.100.200\r\nConnection: keep-alive\r\n"
+	"Upgrade-Insecure-Requests: 1\r\n"
+	"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+	"Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+	"Accept-Encoding: gzip, deflate\r\nAccept-Language: en-GB,en;q=0.9\r\nCache-Control: max-age=0\r\n\r\n";
+
+#if SIMPLE_HTTP_REQUEST_ARENA_SIZE >= (SIMPLE_HTTP_ZERO_COPY_HEADERS ? 1024 : 2048)
+TEST(Request, browserRequestFitsArena) {
+	//whole, in TCP sized pieces and a byte at a time
+	for (int split : { 0, 64, 1 }) {
+		Request r;
+		uint32_t fallbacks = RequestArena::getHeapFallbackCount();
+		Result result = MoreData;
+		if (split == 0) {
+			result = r.parse((char*)browserRequest.data(), browserRequest.size());
+		}
+		for (size_t i = 0; split != 0 && i < browserRequest.size(); i += split) {
+			result = r.parse((char*)browserRequest.data() + i, std::min((size_t)split, browserRequest.size() - i));
+		}
+		GTEST_ASSERT_EQ(result, Result::OK);
+		auto agent = r.getHeader("user-agent");
+		GTEST_ASSERT_EQ(string(agent.value, agent.size).substr(0, 11), "Mozilla/5.0");
+		GTEST_ASSERT_EQ(RequestArena::getHeapFallbackCount(), fallbacks) << "split " << split;
+	}
+}
+#endif
+
+TEST(Request, reuseAfterReset) {
+	Request r;
+	string req("GET /first HTTP/1.1\r\nHost: hello\r\nX-Long-Header-Name: a value long enough to not fit inline\r\n\r\n");
+	for (int i = 0; i < 3; i++) {
+		GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+		GTEST_ASSERT_EQ(r.path, "/first");
+		auto value = r.getHeader("x-long-header-name");
+		GTEST_ASSERT_EQ(string(value.value, value.size), "a value long enough to not fit inline");
+		r.reset();
+	}
+}
+
+TEST(Request, headerNameLength) {
+	string name(Request::MaxHeaderNameLength, 'x');
+	for (int extra : { 0, 1 }) {
+		Request r;
+		string req("GET / HTTP/1.1\r\n" + name + string(extra, 'x') + ": value\r\n\r\n");
+		GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), extra == 0 ? Result::OK : Result::ERROR);
+		if (extra == 0) {
+			auto value = r.getHeader(name.c_str());
+			GTEST_ASSERT_EQ(string(value.value, value.size), "value");
+		}
+	}
+}
+
+TEST(Request, pipelinedRequests) {
+	Request r;
+	string req("GET /a HTTP/1.1\r\nHost: one\r\n\r\nGET /b HTTP/1.1\r\nHost: two\r\n\r\nGET /c HTT");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/a");
+	//received before the first request was finished with
+	string more("P/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)more.c_str(), more.length()), Result::OK);
+
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/b");
+	GTEST_ASSERT_EQ(string(r.getHeader("host").value, r.getHeader("host").size), "two");
+
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/c");
+	GTEST_ASSERT_EQ(r.receivedAllHeaders(), true);
+
+	//nothing left
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.receivedAllHeaders(), false);
+}
+
+TEST(Request, pipelinedLimit) {
+	RequestTest r;
+	string req("GET /a HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+	string next(SIMPLE_HTTP_MAX_PIPELINED_SIZE, 'a');
+	GTEST_ASSERT_EQ(r.parse((char*)next.c_str(), next.length()), Result::OK);
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 0);
+	//over the limit is kept but held so the connection stops reading
+	GTEST_ASSERT_EQ(r.parse((char*)"aa", 2), Result::OK);
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 2);
+	//given back once parsed, the next request is still incomplete
+	GTEST_ASSERT_EQ(r.next(), Result::MoreData);
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 0);
+}
+
+TEST(Request, pipelinedBurst) {
+	//more than SIMPLE_HTTP_MAX_PIPELINED_SIZE sent at once
+	for (int pathLength : { 50, 300 }) {
+		RequestTest r;
+		string all;
+		for (int i = 0; i < 8; i++) {
+			all += "GET /" + std::to_string(i) + string(pathLength, 'p') + " HTTP/1.1\r\nHost: example.com\r\n\r\n";
+		}
+		GTEST_ASSERT_EQ(r.parse((char*)all.c_str(), all.length()), Result::OK);
+		GTEST_ASSERT_GT(r.getRecvHeld(), 0);
+		for (int i = 0; i < 8; i++) {
+			GTEST_ASSERT_EQ(string(r.path.c_str()), "/" + std::to_string(i) + string(pathLength, 'p'));
+			GTEST_ASSERT_EQ(r.next(), Result::OK);
+		}
+		GTEST_ASSERT_EQ(r.getRecvHeld(), 0);
+		GTEST_ASSERT_EQ(r.receivedAllHeaders(), false);
+	}
+}
+
+TEST(Request, pipelinedAfterBodyRead) {
+	Request r;
+	string req("POST /a HTTP/1.1\r\nContent-Length: 4\r\n\r\nTest");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+	char buffer[20] = "";
+	int size = sizeof(buffer);
+	GTEST_ASSERT_EQ(r.readBody(buffer, &size), Result::OK);
+
+	//received after the body was read but before the response
+	string next("GET /b HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)next.c_str(), next.length()), Result::OK);
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.method, Request::GET);
+	GTEST_ASSERT_EQ(r.path, "/b");
+}
+
+TEST(Request, emptyBody) {
+	Request r;
+	string req("POST /a HTTP/1.1\r\nContent-Length: 0\r\n\r\nGET /b HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+	GTEST_ASSERT_EQ(r.method, Request::POST);
+	GTEST_ASSERT_EQ(r.hasUnreadBody(), false);
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/b");
+}
+
+TEST(Request, pipelinedAfterBody) {
+	Request r;
+	string req("POST /a HTTP/1.1\r\nContent-Length: 4\r\n\r\nTestGET /b HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+
+	char buffer[20] = "";
+	int size = sizeof(buffer);
+	GTEST_ASSERT_EQ(r.readBody(buffer, &size), Result::OK);
+	GTEST_ASSERT_EQ(string(buffer, size), "Test");
+
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.method, Request::GET);
+	GTEST_ASSERT_EQ(r.path, "/b");
+}
+
+TEST(Request, unclaimedBodyHeld) {
+	RequestTest r;
+	string req("POST /up HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+	//nothing has said how the body will be read yet
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 5);
+	GTEST_ASSERT_EQ(r.parse((char*)"56", 2), Result::MoreData);
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 7);
+
+	char buffer[4];
+	int size = sizeof(buffer);
+	GTEST_ASSERT_EQ(r.readBody(buffer, &size), Result::MoreData);
+	GTEST_ASSERT_EQ(r.getRecvHeld(), 0);
+}
+
+static string streamedBody;
+static int streamBudget;
+static bool streamEnded;
+
+TEST(Request, streamedBody) {
+	RequestTest r;
+	streamedBody.clear();
+	streamEnded = false;
+	string req("POST /up HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+
+	auto onChunk = [](Request* request, const char* data, int size) {
+		int used = size < streamBudget ? size : streamBudget;
+		streamedBody.append(data, used);
+		streamBudget -= used;
+		return used;
+	};
+	auto onEnd = [](Request* request, Response* response) { streamEnded = true; };
+	GTEST_ASSERT_EQ(r.setBodyHandler(onChunk, onEnd, nullptr), true);
+
+	//the body that came with the headers was already acknowledged so isn't held
+	streamBudget = 3;
+	r.beginBodyStream();
+	GTEST_ASSERT_EQ(streamedBody, "012");
+	GTEST_ASSERT_EQ(r.getBodyHeld(), 0);
+
+	//handler is busy, the new data is held back behind the older data
+	streamBudget = 0;
+	string more("56789GET /next HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)more.c_str(), more.length()), Result::MoreData);
+	GTEST_ASSERT_EQ(r.getBodyHeld(), 5);
+	GTEST_ASSERT_EQ(r.getAndClearForProcessing(), true);
+
+	streamBudget = 4;
+	r.deliverBufferedBody();
+	GTEST_ASSERT_EQ(streamedBody, "0123456");
+	GTEST_ASSERT_EQ(r.getBodyHeld(), 3);
+
+	streamBudget = 100;
+	r.deliverBufferedBody();
+	GTEST_ASSERT_EQ(streamedBody, "0123456789");
+	GTEST_ASSERT_EQ(r.getBodyHeld(), 0);
+	GTEST_ASSERT_EQ(r.getAndClearForProcessing(), true);
+
+	r.endBody(nullptr);
+	GTEST_ASSERT_EQ(streamEnded, true);
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/next");
+}
+
+TEST(Request, expectContinue) {
+	Request r;
+	string req("PUT /up HTTP/1.1\r\nContent-Length: 4\r\nExpect: 100-Continue\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+	GTEST_ASSERT_EQ(r.isExpectingContinue(), true);
+	GTEST_ASSERT_EQ(r.hasUnreadBody(), true);
+
+	char buffer[20] = "";
+	int size = sizeof(buffer);
+	r.readBody(buffer, &size);
+	GTEST_ASSERT_EQ(r.hasUnreadBody(), false);
+
+	r.reset();
+	string noExpect("PUT /up HTTP/1.1\r\nContent-Length: 4\r\n\r\n");
+	r.parse((char*)noExpect.c_str(), noExpect.length());
+	GTEST_ASSERT_EQ(r.isExpectingContinue(), false);
+}
+
+TEST(Request, queryString) {
+	Request r;
+	string req("GET /search?q=a+b%26c&empty=&flag&%6Eame=x%2 HTTP/1.1\r\n\r\n");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/search");
+
+	auto& query = r.getQuery();
+	GTEST_ASSERT_EQ(query.getCount(), 4);
+	auto q = query.get("q");
+	GTEST_ASSERT_EQ(string(q.value, q.size), "a b&c");
+	//decoded in place once, reading it again returns the same
+	auto again = query.get("q");
+	GTEST_ASSERT_EQ(string(again.value, again.size), "a b&c");
+	GTEST_ASSERT_EQ(query.get("empty").size, 0);
+	GTEST_ASSERT_NE(query.get("flag").value, nullptr);
+	auto name = query.get("name");
+	GTEST_ASSERT_EQ(string(name.value, name.size), "x%2");
+	GTEST_ASSERT_EQ(query.get("missing").value, nullptr);
+}
+
+TEST(Request, formBody) {
+	Request r;
+	string req("POST /form HTTP/1.1\r\nContent-Length: 19\r\n\r\nuser=bob&pass=a%3");
+	GTEST_ASSERT_EQ(r.parse((char*)req.c_str(), req.length()), Result::MoreData);
+	FormFields form;
+	GTEST_ASSERT_EQ(r.readForm(&form), Result::MoreData);
+	GTEST_ASSERT_EQ(r.hasUnreadBody(), false);
+
+	string rest("DbGET /next HTTP/1.1\r\n\r\n");
+	r.parse((char*)rest.c_str(), rest.length());
+	GTEST_ASSERT_EQ(r.readForm(&form), Result::OK);
+	auto user = form.get("user");
+	GTEST_ASSERT_EQ(string(user.value, user.size), "bob");
+	auto pass = form.get("pass");
+	GTEST_ASSERT_EQ(string(pass.value, pass.size), "a=b");
+
+	GTEST_ASSERT_EQ(r.next(), Result::OK);
+	GTEST_ASSERT_EQ(r.path, "/next");
+}
+
 //one parse call consumes the full payload
 TEST(Request, fullRequestPOSTFullBodyContentLength) {
 	Request r;
@@ -126,6 +550,60 @@ TEST(Request, fullRequestPOSTFullBodyChunked) {
 	GTEST_ASSERT_EQ(str, expectedText);
 }
 
+TEST(Request, chunkedBodyAnySplit) {
+	string headers("POST /abc HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+	string body("4;name=value\r\nTest\r\n1A\r\nabcdefghijklmnopqrstuvwxyz\r\n0\r\nX-Trailer: 1\r\n\r\nGET /next HTTP/1.1\r\n\r\n");
+	for (int split = 1; split <= (int)body.size(); split++) {
+		Request r;
+		GTEST_ASSERT_EQ(r.parse((char*)headers.c_str(), headers.length()), Result::MoreData);
+		string decoded;
+		Result result = MoreData;
+		for (int pos = 0; pos < (int)body.size(); pos += split) {
+			r.parse((char*)body.c_str() + pos, std::min(split, (int)body.size() - pos));
+			//a small buffer so the output fills part way through a chunk
+			while (result == MoreData) {
+				char buffer[7];
+				int size = sizeof(buffer);
+				result = r.readBody(buffer, &size);
+				decoded.append(buffer, size);
+				if (size == 0) {
+					break;
+				}
+			}
+		}
+		GTEST_ASSERT_EQ(result, Result::OK) << "split " << split;
+		GTEST_ASSERT_EQ(decoded, "Testabcdefghijklmnopqrstuvwxyz") << "split " << split;
+		GTEST_ASSERT_EQ(r.next(), Result::OK);
+		GTEST_ASSERT_EQ(r.path, "/next");
+	}
+}
+
+TEST(Request, chunkedBodyErrors) {
+	const char* bodies[] = {
+		"x\r\n",
+		"\r\n",
+		"fffffffff\r\n",
+		"2\r\nabc\r\n",
+		"0\r\n\rx",
+	};
+	for (auto body : bodies) {
+		ChunkedDecoder decoder;
+		char buffer[20];
+		int inSize = strlen(body);
+		int outSize = sizeof(buffer);
+		GTEST_ASSERT_EQ(decoder.decode(body, &inSize, buffer, &outSize), Result::ERROR) << body;
+	}
+
+	//decoded in place
+	char body[] = "3\r\nabc\r\n2\r\nde\r\n0\r\n\r\n";
+	ChunkedDecoder decoder;
+	int inSize = sizeof(body) - 1;
+	int outSize = inSize;
+	GTEST_ASSERT_EQ(decoder.decode(body, &inSize, body, &outSize), Result::OK);
+	GTEST_ASSERT_EQ(inSize, (int)sizeof(body) - 1);
+	GTEST_ASSERT_EQ(string(body, outSize), "abcde");
+}
+
 TEST(Request, fullRequestRTSPDescribe) {
 	char request[] = {
 	0x44, 0x45, 0x53, 0x43, 0x52, 0x49, 0x42, 0x45,
@@ -19,6 +19,7 @@
  */
 #include "Response.h"
 #include "utility.h"
+#include "DateHeader.h"
 
 using namespace SimpleHTTP;
 
@@ -28,8 +29,10 @@ Response::Response(ServerConnection* conn, bool connectionKeepAlive, HTTPVersion
 	responseBufferPos = responseBufferBodyStart;
 	responseSizeTotal = 0;
 	headersSent = false;
+	headersEnded = false;
 	statusWritten = false;
 	chunkedEncoding = true;
+	headersOnly = conn->currentRequest.method == Request::HEAD;
 	connectionMode = connectionKeepAlive ? ConnectionKeepAlive : ConnectionClose;
 	client = conn;
 	responseVersion = requestVersion;
@@ -51,7 +54,14 @@ bool Response::appendHeaders(const char* headers, int size) {
 			responseBufferPos += size;
 		}
 		else {
-			return false;
+			//otherwise move the body along if there's room after it, keeping space for a chunk size in front of it
+			int shift = responseHeaderBufferPos + size + ChunkedTransferSizeHeaderSize - responseBufferBodyStart;
+			if (headersSent || responseBufferPos + shift > responseBufferEnd) {
+				return false;
+			}
+			memmove(responseBufferBodyStart + shift, responseBufferBodyStart, responseBufferPos - responseBufferBodyStart);
+			responseBufferBodyStart += shift;
+			responseBufferPos += shift;
 		}
 	}
 
@@ -134,7 +144,7 @@ int Response::write(const char* data) {
 
 int Response::writeDirect(const char* data, int length) {
 	int result = flush();
-	if (result != 0) {
+	if (result != 0 || headersOnly) {
 		return result;
 	}
 
@@ -146,6 +156,14 @@ int Response::writeDirect(const char* data, int length) {
 	return ERROR;
 }
 
+bool Response::sendContinue() {
+	if (headersSent || !client->currentRequest.isExpectingContinue()) {
+		return false;
+	}
+	client->currentRequest.continueSent = true;
+	return client->writeData((const uint8_t*)ContinueResponse.value, ContinueResponse.size, Transport::WriteFlagZeroCopy);
+}
+
 bool Response::writeHeader(Response::Status status) {
 	if (headersSent || statusWritten) {
 		return false;
@@ -162,26 +180,80 @@ bool Response::writeHeader(Response::Status status) {
 
 }
 
-bool Response::writeHeaderLine(const SimpleString str) {
-	return writeHeaderLine(str.value, str.size);
+bool Response::writeHeader(const ResponseProfile& profile) {
+	if (headersSent || statusWritten || !profile.isValid()) {
+		return false;
+	}
+	char* start = responseHeaderBufferPos;
+	if (!appendHeaders(profile.block, profile.size)) {
+		return false;
+	}
+	//profiles are built for HTTP/1.1, the other versions are the same length
+	if (responseVersion != HTTP11) {
+		memcpy(start, HTTPVersions[responseVersion].value, HTTPVersions[responseVersion].size);
+	}
+	statusWritten = true;
+	return true;
 }
 
-void Response::addContentLengthHeader(int length) {
-	ensureStatusWritten();
+ResponseProfile::ResponseProfile(Response::Status status, const char* contentType, const char* headers) : size(0) {
+	auto strStatus = Response::statusStrings[status];
+	auto strVersion = HTTPVersions[HTTP11];
+	bool fits = append(strVersion.value, strVersion.size)
+		&& append(" ", 1)
+		&& append(strStatus.value, strStatus.size)
+		&& append(Response::EOL, sizeof(Response::EOL));
+	if (fits && contentType != nullptr) {
+		fits = append("Content-Type: ", 14)
+			&& append(contentType, strlen(contentType))
+			&& append(Response::EOL, sizeof(Response::EOL));
+	}
+	if (fits && headers != nullptr) {
+		fits = append(headers, strlen(headers));
+	}
+	if (!fits) {
+		size = 0;
+	}
+}
 
-	memcpy(responseHeaderBufferPos, ContentLengthHeader.value, ContentLengthHeader.size);
-	responseHeaderBufferPos += ContentLengthHeader.size;
+bool ResponseProfile::append(const char* data, int length) {
+	if (size + length > MaxSize) {
+		return false;
+	}
+	memcpy(block + size, data, length);
+	size += length;
+	return true;
+}
 
-	auto lengthSize = Utility::toASCII(length, responseHeaderBufferPos, Utility::DecBase, 10);
-	responseHeaderBufferPos += lengthSize;
+bool Response::writeHeaderLine(const SimpleString str) {
+	return writeHeaderLine(str.value, str.size);
+}
 
+void Response::addContentLengthHeader(uint32_t length) {
+	ensureStatusWritten();
 
-	memcpy(responseHeaderBufferPos, EOL, sizeof(EOL));
-	responseHeaderBufferPos += sizeof(EOL);
+	char line[ContentLengthHeader.size + 10 + sizeof(EOL)];
+	memcpy(line, ContentLengthHeader.value, ContentLengthHeader.size);
+	int lineSize = ContentLengthHeader.size;
+	lineSize += Utility::formatDecimal(length, line + lineSize, 10);
+	memcpy(line + lineSize, EOL, sizeof(EOL));
+	lineSize += sizeof(EOL);
+	appendHeaders(line, lineSize);
 
 	chunkedEncoding = false;
 }
 
+void Response::addKeepAliveHeader() {
+	char line[ConnectionKeepAliveHeader.size + 10 + sizeof(EOL)];
+	memcpy(line, ConnectionKeepAliveHeader.value, ConnectionKeepAliveHeader.size);
+	int lineSize = ConnectionKeepAliveHeader.size;
+	//whole seconds, rounded down so a client never expects the connection to outlive its timer
+	lineSize += Utility::formatDecimal(client->getKeepaliveTimeout() / 1000, line + lineSize, 10);
+	memcpy(line + lineSize, EOL, sizeof(EOL));
+	lineSize += sizeof(EOL);
+	appendHeaders(line, lineSize);
+}
+
 bool Response::writeHeaderLine(const char* name, int size) {
 	return ensureStatusWritten()
 		&& appendHeaders(name, size)
@@ -209,37 +281,43 @@ Result Response::flush(bool finalise) {
 
 	int chunkSize = responseBufferPos - responseBufferBodyStart;
 
-	if (!headersSent) {
+	if (!headersEnded) {
 		//if this is the one and only "chunk" of body data just use a content length header
 		//if flush was called without adding a content length we are now stuck
 		//unless a header was added directly
+		ensureStatusWritten();
 		if (!headersSent && finalise) {
 			addContentLengthHeader(chunkSize);
 		}
 		else if (chunkedEncoding) {
-			writeHeaderLine(ChunckedTransferHeader);
+			appendHeaders(ChunckedTransferHeader.value, ChunckedTransferHeader.size);
 		}
 
 		switch (connectionMode) {
 		case ConnectionKeepAlive:
-			writeHeaderLine(ConnectionKeepAliveHeader);
+			addKeepAliveHeader();
 			break;
 		case ConnectionClose:
-			writeHeaderLine(ConnectionCloseHeader);
+			appendHeaders(ConnectionCloseHeader.value, ConnectionCloseHeader.size);
 			break;
 		case ConnectionUpgrade:
-			writeHeaderLine(ConnectionUpgradeHeader);
+			appendHeaders(ConnectionUpgradeHeader.value, ConnectionUpgradeHeader.size);
 			break;
 		}
+#if SIMPLE_HTTP_DATE_HEADER
+		auto date = DateHeader::get();
+		if (date.value != nullptr) {
+			appendHeaders(date.value, date.size);
+		}
+#endif
 
 		//append the headers end
-		writeHeaderLine("", 0);
+		appendHeadersEOL();
+		headersEnded = true;
+	}
 
-		Result result = networkWrite(responseBuffer, responseHeaderBufferPos - responseBuffer);
-		if (result != OK) {
-			return ERROR;
-		}
-		headersSent = true;
+	if (headersOnly) {
+		return flushHeadersOnly();
 	}
 
 	//preend the chunk size to the payload and trailing new line
@@ -247,7 +325,7 @@ Result Response::flush(bool finalise) {
 	if (chunkedEncoding) {
 
 		char tmp[ChunkedTransferSizeHeaderSize] = "";
-		auto lengthSize = Utility::toASCII(chunkSize, tmp, Utility::HexBase, sizeof(tmp));
+		auto lengthSize = Utility::formatHex(chunkSize, tmp, sizeof(tmp) - sizeof(EOL));
 		memcpy(tmp + lengthSize, EOL, sizeof(EOL));
 		lengthSize += sizeof(EOL);
 
@@ -266,20 +344,49 @@ Result Response::flush(bool finalise) {
 
 
 
-	auto result = networkWrite(responseBufferBodyStart, responseBufferPos - responseBufferBodyStart);
+	//move the headers up against the body so they go out as one write (and one segment for small responses)
+	char* writeStart = responseBufferBodyStart;
+	int headersSize = 0;
+	if (!headersSent) {
+		headersSize = responseHeaderBufferPos - responseBuffer;
+		writeStart -= headersSize;
+		memmove(writeStart, responseBuffer, headersSize);
+	}
+
+	auto result = networkWrite(writeStart, responseBufferPos - writeStart);
 	if (result == OK) {
+		headersSent = true;
 		//no longer need the reserved space for the headers once the headers have been sent
 		responseBufferBodyStart = responseBuffer + ChunkedTransferSizeHeaderSize;
 		responseBufferPos = responseBufferBodyStart;
 		responseHeaderBufferPos = responseBuffer;
 	}
-	else if (chunkedEncoding) {
-		responseBufferBodyStart = beforeChunkAdd;
+	else {
+		//back where they were so the next flush can try again
+		memmove(responseBuffer, writeStart, headersSize);
+		if (chunkedEncoding) {
+			responseBufferBodyStart = beforeChunkAdd;
+		}
 	}
 
 	return result;
 }
 
+Result Response::flushHeadersOnly() {
+	Result result = OK;
+	if (!headersSent) {
+		result = networkWrite(responseBuffer, responseHeaderBufferPos - responseBuffer);
+	}
+	if (result == OK) {
+		//the body is dropped but counted in to the Content-Length already
+		headersSent = true;
+		responseBufferBodyStart = responseBuffer + ChunkedTransferSizeHeaderSize;
+		responseBufferPos = responseBufferBodyStart;
+		responseHeaderBufferPos = responseBuffer;
+	}
+	return result;
+}
+
 ServerConnection* Response::hijackConnection() {
 	client->hijacted = true;
 	return client;
@@ -300,3 +407,4 @@ const constexpr struct SimpleString Response::ConnectionCloseHeader;
 const constexpr struct SimpleString Response::ConnectionUpgradeHeader;
 const constexpr struct SimpleString Response::ChunckedTransferHeader;
 const constexpr struct SimpleString Response::ContentLengthHeader;
+const constexpr struct SimpleString Response::ContinueResponse;
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "Response.h"
 #include "MockServerConnection.h"
+#include "DateHeader.h"
 using SimpleHTTP::Response;
 using SimpleHTTPTest::MockServerConnection;
 
@@ -29,7 +30,15 @@ TEST(Response, DefaultResponse) {
 	MockServerConnection conn;
 	Response r(&conn, true, SimpleHTTP::HTTP11);
 	r.finalize();
-	ASSERT_EQ(conn.buffer, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nKeep-Alive: timeout=15, max=1000\r\n\r\n");
+	ASSERT_EQ(conn.buffer, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nKeep-Alive: timeout=60\r\n\r\n");
+}
+
+TEST(Response, KeepAliveTimeout) {
+	MockServerConnection conn;
+	Response r(&conn, true, SimpleHTTP::HTTP11);
+	r.setKeepaliveTimeout(5500);
+	r.finalize();
+	ASSERT_EQ(conn.buffer, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\nKeep-Alive: timeout=5\r\n\r\n");
 }
 
 TEST(Response, SingleWrite) {
@@ -38,10 +47,60 @@ TEST(Response, SingleWrite) {
 	string str = "Hello World";
 	r.write(str.c_str(), str.length());
 	r.finalize();
-	string expected = "HTTP/1.1 200 OK\r\nContent-Length: 11\r\nKeep-Alive: timeout=15, max=1000\r\n\r\nHello World";
+	string expected = "HTTP/1.1 200 OK\r\nContent-Length: 11\r\nKeep-Alive: timeout=60\r\n\r\nHello World";
 	ASSERT_EQ(conn.buffer, expected);
 }
 
+TEST(Response, HeadersAndBodyInOneWrite) {
+	MockServerConnection conn;
+	Response r(&conn, true, SimpleHTTP::HTTP11);
+	r.write("Hello World");
+	r.finalize();
+	ASSERT_EQ(conn.getWriteCount(), 1);
+
+	MockServerConnection chunked;
+	Response c(&chunked, true, SimpleHTTP::HTTP11);
+	c.write("Hello World");
+	c.flush();
+	ASSERT_EQ(chunked.getWriteCount(), 1);
+}
+
+TEST(Response, Profile) {
+	static const SimpleHTTP::ResponseProfile json(Response::Ok, "application/json", "Cache-Control: no-store\r\n");
+	MockServerConnection conn;
+	Response r(&conn, true, SimpleHTTP::HTTP11);
+	ASSERT_TRUE(r.writeHeader(json));
+	ASSERT_FALSE(r.writeHeader(Response::NotFound));
+	r.write("{}");
+	r.finalize();
+	ASSERT_EQ(conn.buffer, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-store\r\nContent-Length: 2\r\nKeep-Alive: timeout=60\r\n\r\n{}");
+
+	MockServerConnection http10;
+	Response old(&http10, false, SimpleHTTP::HTTP10);
+	ASSERT_TRUE(old.writeHeader(json));
+	old.finalize();
+	ASSERT_EQ(http10.buffer, "HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-store\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+
+	string tooLarge(SimpleHTTP::ResponseProfile::MaxSize, 'x');
+	SimpleHTTP::ResponseProfile invalid(Response::Ok, nullptr, tooLarge.c_str());
+	ASSERT_FALSE(invalid.isValid());
+}
+
+TEST(Response, DateHeader) {
+	char line[SimpleHTTP::DateHeader::Size];
+	SimpleHTTP::DateHeader::format(784111777, line);
+	ASSERT_EQ(string(line, sizeof(line)), "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n");
+	SimpleHTTP::DateHeader::format(951782400, line);
+	ASSERT_EQ(string(line, sizeof(line)), "Date: Tue, 29 Feb 2000 00:00:00 GMT\r\n");
+	SimpleHTTP::DateHeader::format(4102444799, line);
+	ASSERT_EQ(string(line, sizeof(line)), "Date: Thu, 31 Dec 2099 23:59:59 GMT\r\n");
+
+	auto now = SimpleHTTP::DateHeader::get();
+	ASSERT_EQ(now.size, SimpleHTTP::DateHeader::Size);
+	//the same buffer is reused within the second
+	ASSERT_EQ(SimpleHTTP::DateHeader::get().value, now.value);
+}
+
 TEST(Response, SingleChunk) {
 	MockServerConnection conn;
 	Response r(&conn, true, SimpleHTTP::HTTP11);
@@ -49,7 +108,7 @@ TEST(Response, SingleChunk) {
 	r.write(str.c_str(), str.length());
 	r.flush();
 	string sizeChunk = "B\r\n";
-	string expectedResponse = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nKeep-Alive: timeout=15, max=1000\r\n\r\n" + sizeChunk + str+"\r\n";
+	string expectedResponse = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nKeep-Alive: timeout=60\r\n\r\n" + sizeChunk + str+"\r\n";
 	
 	ASSERT_EQ(conn.buffer, expectedResponse);
 	
@@ -66,7 +125,7 @@ TEST(Response, ManyChunks) {
 	
 	Response r(&conn, true,SimpleHTTP::HTTP11);
 
-	string expectedResponse = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nKeep-Alive: timeout=15, max=1000\r\n\r\n17E\r\nHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello Wo\r\nA8\r\nrldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello World\r\n0\r\n\r\n";
+	string expectedResponse = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\nKeep-Alive: timeout=60\r\n\r\n17E\r\nHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello Wo\r\nA8\r\nrldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello WorldHello World\r\n0\r\n\r\n";
 	string msg = "Hello World";
 
 	for (int i = 0; i < 50; i++) {
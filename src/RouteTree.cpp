@@ -0,0 +1,184 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RouteTree.h"
+#include "log.h"
+#include <string.h>
+
+using namespace SimpleHTTP;
+
+RouteTree::Node::~Node()
+{
+	for (auto child : children) {
+		delete child;
+	}
+	delete paramChild;
+	delete wildcardChild;
+}
+
+RouteTree::Node* RouteTree::addStatic(Node* node, const char* path, int length)
+{
+	while (length > 0) {
+		Node* next = nullptr;
+		int childIndex = 0;
+		for (; childIndex < (int)node->children.size(); childIndex++) {
+			if (node->children[childIndex]->prefix[0] == path[0]) {
+				next = node->children[childIndex];
+				break;
+			}
+		}
+
+		if (next == nullptr) {
+			next = new Node();
+			next->prefix.assign(path, length);
+			node->children.push_back(next);
+			return next;
+		}
+
+		int common = 0;
+		int prefixLength = next->prefix.size();
+		while (common < prefixLength && common < length && next->prefix[common] == path[common]) {
+			common++;
+		}
+
+		if (common < prefixLength) {
+			//split so the shared part becomes its own node
+			Node* split = new Node();
+			split->prefix = next->prefix.substr(0, common);
+			next->prefix.erase(0, common);
+			split->children.push_back(next);
+			node->children[childIndex] = split;
+			next = split;
+		}
+
+		node = next;
+		path += common;
+		length -= common;
+	}
+	return node;
+}
+
+int RouteTree::add(const string& path, int value)
+{
+	Node* node = &root;
+	const char* pos = path.c_str();
+	const char* end = pos + path.size();
+
+	while (pos < end) {
+		//static text runs up to a segment starting with : or *
+		const char* staticEnd = pos;
+		while (staticEnd < end && !((*staticEnd == ':' || *staticEnd == '*') && staticEnd > path.c_str() && staticEnd[-1] == '/')) {
+			staticEnd++;
+		}
+		node = addStatic(node, pos, staticEnd - pos);
+		pos = staticEnd;
+		if (pos == end) {
+			break;
+		}
+
+		if (*pos == '*') {
+			if (node->wildcardChild == nullptr) {
+				node->wildcardChild = new Node();
+				node->wildcardChild->paramName.assign(pos + 1, end - pos - 1);
+				if (node->wildcardChild->paramName.empty()) {
+					node->wildcardChild->paramName = "*";
+				}
+			}
+			node = node->wildcardChild;
+			break;
+		}
+
+		const char* nameEnd = (const char*)memchr(pos, '/', end - pos);
+		if (nameEnd == nullptr) {
+			nameEnd = end;
+		}
+		if (node->paramChild == nullptr) {
+			node->paramChild = new Node();
+			node->paramChild->paramName.assign(pos + 1, nameEnd - pos - 1);
+		}
+		else if (node->paramChild->paramName.compare(0, string::npos, pos + 1, nameEnd - pos - 1) != 0) {
+			SHTTP_LOGE(__FUNCTION__, "%s param name differs from an existing route, using :%s", path.c_str(), node->paramChild->paramName.c_str());
+		}
+		node = node->paramChild;
+		pos = nameEnd;
+	}
+
+	if (node->value == -1) {
+		node->value = value;
+	}
+	return node->value;
+}
+
+int RouteTree::find(const char* path, int length, Request::PathParam* params, int maxParams, int* paramCount) const
+{
+	const char* query = (const char*)memchr(path, '?', length);
+	if (query != nullptr) {
+		length = query - path;
+	}
+	*paramCount = 0;
+	return match(&root, path, length, path, params, maxParams, paramCount);
+}
+
+int RouteTree::match(const Node* node, const char* path, int length, const char* pathStart, Request::PathParam* params, int maxParams, int* paramCount)
+{
+	if (length == 0 && node->value != -1) {
+		return node->value;
+	}
+
+	if (length > 0) {
+		for (auto child : node->children) {
+			int prefixLength = child->prefix.size();
+			if (child->prefix[0] == path[0] && prefixLength <= length && memcmp(child->prefix.data(), path, prefixLength) == 0) {
+				int result = match(child, path + prefixLength, length - prefixLength, pathStart, params, maxParams, paramCount);
+				if (result != -1) {
+					return result;
+				}
+				//only one child can share the first character
+				break;
+			}
+		}
+
+		if (node->paramChild != nullptr) {
+			const char* segmentEnd = (const char*)memchr(path, '/', length);
+			int segmentLength = segmentEnd ? segmentEnd - path : length;
+			if (segmentLength > 0) {
+				int captured = *paramCount;
+				if (captured < maxParams) {
+					params[captured] = { node->paramChild->paramName.c_str(), (uint16_t)(path - pathStart), (uint16_t)segmentLength };
+					(*paramCount)++;
+				}
+				int result = match(node->paramChild, path + segmentLength, length - segmentLength, pathStart, params, maxParams, paramCount);
+				if (result != -1) {
+					return result;
+				}
+				*paramCount = captured;
+			}
+		}
+	}
+
+	if (node->wildcardChild != nullptr && node->wildcardChild->value != -1) {
+		if (*paramCount < maxParams) {
+			params[*paramCount] = { node->wildcardChild->paramName.c_str(), (uint16_t)(path - pathStart), (uint16_t)length };
+			(*paramCount)++;
+		}
+		return node->wildcardChild->value;
+	}
+
+	return -1;
+}
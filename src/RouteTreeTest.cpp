@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "RouteTree.h"
+#include "StaticRoutes.h"
+#include <string.h>
+using namespace SimpleHTTP;
+
+static int find(RouteTree& tree, const char* path, Request::PathParam* params = nullptr, int* count = nullptr) {
+	Request::PathParam p[Request::MaxPathParams];
+	int c;
+	return tree.find(path, strlen(path), params ? params : p, Request::MaxPathParams, count ? count : &c);
+}
+
+TEST(RouteTree, StaticRoutes) {
+	RouteTree tree;
+	tree.add("/", 0);
+	tree.add("/api", 1);
+	tree.add("/apple", 2);
+	tree.add("/api/users", 3);
+	ASSERT_EQ(find(tree, "/"), 0);
+	ASSERT_EQ(find(tree, "/api"), 1);
+	ASSERT_EQ(find(tree, "/apple"), 2);
+	ASSERT_EQ(find(tree, "/api/users"), 3);
+	ASSERT_EQ(find(tree, "/ap"), -1);
+	ASSERT_EQ(find(tree, "/api/users/1"), -1);
+	ASSERT_EQ(find(tree, "/api?x=1"), 1);
+}
+
+TEST(RouteTree, ParamsAndWildcards) {
+	RouteTree tree;
+	tree.add("/api/:id", 0);
+	tree.add("/api/:id/items/:item", 1);
+	tree.add("/api/new", 2);
+	tree.add("/static/*", 3);
+	tree.add("/files/*path", 4);
+
+	Request::PathParam params[Request::MaxPathParams];
+	int count;
+	const char* path = "/api/42/items/abc?x=y";
+	ASSERT_EQ(find(tree, path, params, &count), 1);
+	ASSERT_EQ(count, 2);
+	ASSERT_STREQ(params[0].name, "id");
+	ASSERT_EQ(string(path + params[0].offset, params[0].length), "42");
+	ASSERT_STREQ(params[1].name, "item");
+	ASSERT_EQ(string(path + params[1].offset, params[1].length), "abc");
+
+	ASSERT_EQ(find(tree, "/api/new"), 2);
+	ASSERT_EQ(find(tree, "/api/newer", params, &count), 0);
+	ASSERT_EQ(count, 1);
+	ASSERT_EQ(find(tree, "/api/"), -1);
+
+	path = "/static/js/app.js";
+	ASSERT_EQ(find(tree, path, params, &count), 3);
+	ASSERT_STREQ(params[0].name, "*");
+	ASSERT_EQ(string(path + params[0].offset, params[0].length), "js/app.js");
+	ASSERT_EQ(find(tree, "/files/a/b", params, &count), 4);
+	ASSERT_STREQ(params[0].name, "path");
+	ASSERT_EQ(find(tree, "/static"), -1);
+}
+
+static void staticA(Request*, Response*) {}
+static void staticB(Request*, Response*) {}
+static void staticC(Request*, Response*) {}
+
+static constexpr char rootPath[] = "/";
+static constexpr char apiPath[] = "/api";
+static constexpr char usersPath[] = "/api/users";
+static constexpr char apjPath[] = "/apj";
+
+TEST(StaticRoutes, FindsExactPaths) {
+	using Routes = StaticRoutes<Route<rootPath, staticA>, Route<apiPath, staticB>, Route<usersPath, staticC>, Route<apjPath, staticA>>;
+	ASSERT_EQ(Routes::find("/", 1), staticA);
+	ASSERT_EQ(Routes::find("/api", 4), staticB);
+	ASSERT_EQ(Routes::find("/api?x=1", 8), staticB);
+	ASSERT_EQ(Routes::find("/api/users", 10), staticC);
+	ASSERT_EQ(Routes::find("/apj", 4), staticA);
+	ASSERT_EQ(Routes::find("/apk", 4), nullptr);
+	ASSERT_EQ(Routes::find("/api/", 5), nullptr);
+	ASSERT_EQ(Routes::find("", 0), nullptr);
+}
@@ -21,9 +21,70 @@
 #include "log.h"
 using namespace SimpleHTTP;
 
+Router::RouteHandlers* Router::addRoute(const string& path)
+{
+	int index = routes.add(path, routeHandlers.size());
+	if (index == (int)routeHandlers.size())
+	{
+		routeHandlers.push_back({});
+	}
+	return &routeHandlers[index];
+}
+
 void Router::addHandler(string path, RequestHandler handler)
 {
-	handlers[path] = handler;
+	addRoute(path)->any = handler;
+}
+
+void Router::addHandler(Request::Method method, string path, RequestHandler handler)
+{
+	if (method < 0 || method >= Request::UnknownMethod)
+	{
+		return;
+	}
+	addRoute(path)->methods[method] = handler;
+}
+
+bool Router::allowedMethodsHandler(RouteHandlers* route, Request* request, Response* response)
+{
+	char allow[128];
+	int length = 0;
+	bool hasHandlers = false;
+	for (int m = 0; m < Request::UnknownMethod; m++)
+	{
+		//HEAD is answered by the GET handler
+		bool handled = route->methods[m] != 0 || (m == Request::HEAD && route->methods[Request::GET] != 0);
+		if (!handled && m != Request::OPTIONS)
+		{
+			continue;
+		}
+		hasHandlers |= handled;
+		auto name = Request::methodName((Request::Method)m);
+		if (length + name.size + 2 >= (int)sizeof(allow))
+		{
+			break;
+		}
+		if (length != 0)
+		{
+			allow[length++] = ',';
+			allow[length++] = ' ';
+		}
+		memcpy(allow + length, name.value, name.size);
+		length += name.size;
+	}
+	allow[length] = 0;
+
+	if (!hasHandlers)
+	{
+		return false;
+	}
+
+	if (request->method != Request::OPTIONS)
+	{
+		response->writeHeader(Response::MethodNotAllowed);
+	}
+	response->writeHeaderLine("Allow", allow);
+	return true;
 }
 
 void Router::internalDefaultHandler(Request *req, Response *resp)
@@ -46,96 +107,66 @@ void Router::setDefaultHandler(RequestHandler handler)
 	}
 }
 
-void Router::process()
+void Router::handleRequest(Request* request, Response* response)
 {
-	auto connCountInUse = getConnectionsInUseCount();
-	if( lastConnectionsInUse != connCountInUse){
-		SHTTP_LOGI(__FUNCTION__,"%d connections in use",connCountInUse);
-		lastConnectionsInUse = connCountInUse;
-	}
-	for (int i = 0; i < maxClientConnections; i++)
+	if (staticRoutes != nullptr)
 	{
-		if (clients[i].isConnected())
+		auto handler = staticRoutes(request->path.data(), request->path.size());
+		if (handler != 0)
 		{
-			auto client = &clients[i];
-			if (client->currentRequest.getAndClearForProcessing())
-			{
-
-				bool connectionKeepAlive = false;
-				auto connHeader = client->currentRequest.headers["CONNECTION"];
-				if (connHeader == "keep-alive" 
-				#if defined(SIMPLE_HTTP_RTSP_SUPPORT) && SIMPLE_HTTP_RTSP_SUPPORT == 1
-					//RTSP is keepalive by default
-					|| client->currentRequest.version == HTTPVersion::RTSP10
-				#endif
-				){
-					connectionKeepAlive = true;
-				}
-
-				Response resp(client, connectionKeepAlive,client->currentRequest.version);
-				auto path = client->currentRequest.path;
-
-				auto h = handlers[path];
-				if (h == 0)
-				{
-					defaultHandler(&client->currentRequest, &resp);
-				}
-				else
-				{
-					h(&client->currentRequest, &resp);
-				}
-
-				if( ! client->currentRequest.isBodyReadInProgress() ){
-					resp.finalize();
-                
-					client->currentRequest.reset();
-					client->lastRequestTime = os_getUnixTime();
-					if (resp.getConnectionMode() == Response::ConnectionClose)
-					{
-						client->closeOnceSent = resp.getResponseSizeSent();
-					}
-				}else{
-					//TODO allow data to be written while a body receive is in progress
-					//resp.flush();
-				}
-			}
-			else
-			{
-				if (!client->hijacted && client->lastRequestTime != 0 && os_getUnixTime() - client->lastRequestTime > KeepaliveTimeout)
-				{
-					SHTTP_LOGI(__FUNCTION__,"closing http connection");
-					client->close();
-				}
-			}
+			handler(request, response);
+			return;
 		}
 	}
+
+	int route = routes.find(request->path.data(), request->path.size(), request->pathParams, Request::MaxPathParams, &request->pathParamCount);
+	if (route == -1)
+	{
+		defaultHandler(request, response);
+		return;
+	}
+
+	auto handlers = &routeHandlers[route];
+	RequestHandler handler = 0;
+	if (request->method >= 0 && request->method < Request::UnknownMethod)
+	{
+		handler = handlers->methods[request->method];
+	}
+	if (handler == 0 && request->method == Request::HEAD)
+	{
+		//Response drops the body for HEAD
+		handler = handlers->methods[Request::GET];
+	}
+	if (handler == 0)
+	{
+		handler = handlers->any;
+	}
+
+	if (handler != 0)
+	{
+		handler(request, response);
+	}
+	else if (!allowedMethodsHandler(handlers, request, response))
+	{
+		defaultHandler(request, response);
+	}
+}
+
+void Router::process()
+{
+	defaultPool.process();
 }
 
 ServerConnection* Router::getFreeConnection() {
-	for (int i = 0; i < maxClientConnections; i++)
-	{
-		if (!clients[i].isConnected())
-		{
-            return &clients[i];
-        }
-    }
-    return nullptr;
+	return defaultPool.getFreeConnection();
 }
 
 int Router::getConnectionsInUseCount() {
-	int count =0;
-	for (int i = 0; i < maxClientConnections; i++)
-	{
-		if (clients[i].isConnected())
-		{
-            count++;
-        }
-    }
-	return count;
+	return defaultPool.getConnectionsInUseCount();
 }
 
-ServerConnection Router::clients[];
-std::map<string, RequestHandler> Router::handlers;
+StaticRouteLookup Router::staticRoutes = nullptr;
+RouteTree Router::routes;
+std::vector<Router::RouteHandlers> Router::routeHandlers;
 RequestHandler Router::defaultHandler = Router::internalDefaultHandler;
-int Router::lastConnectionsInUse = 0;
-
+ConnectionPool Router::defaultPool;
\ No newline at end of file
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "Router.h"
+#include "MockServerConnection.h"
+#include <string.h>
+using namespace SimpleHTTP;
+using SimpleHTTPTest::MockServerConnection;
+
+static void getItem(Request*, Response* resp) {
+	resp->write("item");
+}
+
+static void postItem(Request*, Response* resp) {
+	resp->writeHeader(Response::Created);
+}
+
+//runs the router for a raw request, returns what was written to the connection
+static std::string route(const char* raw) {
+	MockServerConnection conn;
+	char data[256];
+	int length = strlen(raw);
+	memcpy(data, raw, length);
+	if (conn.currentRequest.parse(data, length) == ERROR) {
+		return "";
+	}
+	Response resp(&conn, true, HTTP11);
+	Router::handleRequest(&conn.currentRequest, &resp);
+	resp.finalize();
+	return conn.buffer;
+}
+
+class RouterMethods : public ::testing::Test {
+protected:
+	static void SetUpTestSuite() {
+		Router::addHandler(Request::GET, "/router/item", getItem);
+		Router::addHandler(Request::POST, "/router/item", postItem);
+	}
+};
+
+TEST_F(RouterMethods, HandledMethod) {
+	ASSERT_EQ(route("GET /router/item HTTP/1.1\r\n\r\n"), "HTTP/1.1 200 OK\r\nContent-Length: 4\r\nKeep-Alive: timeout=60\r\n\r\nitem");
+	ASSERT_EQ(route("POST /router/item HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}"), "HTTP/1.1 201 Created\r\nContent-Length: 0\r\nKeep-Alive: timeout=60\r\n\r\n");
+}
+
+TEST_F(RouterMethods, MethodNotAllowed) {
+	ASSERT_EQ(route("DELETE /router/item HTTP/1.1\r\n\r\n"), "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD, POST, OPTIONS\r\nContent-Length: 0\r\nKeep-Alive: timeout=60\r\n\r\n");
+}
+
+TEST_F(RouterMethods, Options) {
+	ASSERT_EQ(route("OPTIONS /router/item HTTP/1.1\r\n\r\n"), "HTTP/1.1 200 OK\r\nAllow: GET, HEAD, POST, OPTIONS\r\nContent-Length: 0\r\nKeep-Alive: timeout=60\r\n\r\n");
+}
+
+TEST_F(RouterMethods, HeadUsesGetHandler) {
+	//same headers as GET, no body
+	ASSERT_EQ(route("HEAD /router/item HTTP/1.1\r\n\r\n"), "HTTP/1.1 200 OK\r\nContent-Length: 4\r\nKeep-Alive: timeout=60\r\n\r\n");
+}
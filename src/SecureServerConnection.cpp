@@ -203,6 +203,19 @@ int SecureServerConnection::write(const void* dataptr, u16_t len, u8_t apiflags)
 }
 
 
+int SecureServerConnection::writev(const WriteSegment* segments, int count) {
+	//mbedtls copies everything in to its records so there are no flags to pass on
+	int total = 0;
+	for (int i = 0; i < count; i++) {
+		int written = write(segments[i].data, segments[i].len, 0);
+		if (written < 0) {
+			return total > 0 ? total : written;
+		}
+		total += written;
+	}
+	return total;
+}
+
 int SecureServerConnection::mbedtlsTCPSendCallback(void* ctx, const unsigned char* buf, size_t len) {
 	return static_cast<SecureServerConnection*>(ctx)->mbedtlsTCPSendCallback(buf, len);
 }
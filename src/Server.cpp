@@ -56,12 +56,13 @@ err_t Server::tcp_recv_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p,
 			return ERR_OK;
 		}
 
+		int heldBefore = conn->getRecvHeld();
 		if (conn->dataReceived)
 		{
 			auto pack = p;
 			while(pack){
 				conn->dataReceived(conn->dataReceivedArg, (uint8_t *)pack->payload, pack->len);
-				pack = p->next;
+				pack = pack->next;
 			}
 		}
 		else
@@ -74,7 +75,8 @@ err_t Server::tcp_recv_cb(void *arg, struct tcp_pcb *tpcb, struct pbuf *p,
 			}
 		}
 
-		tcp_recved(tpcb, p->len);
+		//a streamed body handler may hold some back until it takes it
+		tcp_recved(tpcb, p->tot_len - (conn->getRecvHeld() - heldBefore));
 		pbuf_free(p);
 		err_t result = ERR_OK; // conn->recv_cb(p, err);
 		return result;
@@ -89,16 +91,12 @@ err_t Server::tcp_sent_cb(void *arg, struct tcp_pcb *tpcb, u16_t len)
 	{
 		ServerConnection *conn = (ServerConnection *)arg;
 
-		if (conn->closeOnceSent)
+		conn->sendCompleteCallback(len);
+
+		if (conn->closeOnceSent && conn->allSent())
 		{
-			conn->closeOnceSent -= len;
-			if (!conn->closeOnceSent)
-			{
-				conn->closeWithOutLocking();
-			}
+			conn->closeWithOutLocking();
 		}
-
-		conn->sendCompleteCallback(len);
 	}
 
 	return ERR_OK;
@@ -18,6 +18,7 @@
  *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "ServerConnection.h"
+#include "ConnectionPool.h"
 
 using namespace SimpleHTTP;
 
@@ -25,17 +26,33 @@ bool ServerConnection::isConnected() {
 	return transport != 0;
 }
 
-ServerConnection::ServerConnection() {
+ServerConnection::ServerConnection() : transport(0), pool(nullptr), nextReady(nullptr), queuedForProcessing(false) {
 	init(0);
 }
 
+void ServerConnection::setTransport(Transport* t) {
+	if (pool != nullptr && (transport == 0) != (t == 0)) {
+		pool->connectionsInUse += t ? 1 : -1;
+	}
+	transport = t;
+}
+
+uint32_t ServerConnection::getKeepaliveTimeout() {
+	if (keepaliveTimeout != 0) {
+		return keepaliveTimeout;
+	}
+	return pool != nullptr ? pool->keepaliveTimeout : ConnectionPool::KeepaliveTimeout;
+}
+
 void ServerConnection::init(struct tcp_pcb* client) {
 
 	hijacted = false;
-	closeOnceSent = 0;
+	closeOnceSent = false;
+	recvHeld = 0;
 	waitingForSendCompleteSize = 0;
 
 	lastRequestTime = 0;
+	keepaliveTimeout = 0;
 
 	dataReceived = parseRequest;
 	dataReceivedArg = this;
@@ -49,17 +66,17 @@ void ServerConnection::init(struct tcp_pcb* client) {
 	this->currentRequest.reset();
 	if (client != 0) {
 		this->defaultTransport.setPCB(client);
-		this->transport = &defaultTransport;
+		setTransport(&defaultTransport);
 	}
 	else {
-		this->transport = 0;
+		setTransport(0);
 	}
 }
 
 void ServerConnection::init(struct tcp_pcb* client, Transport* t) {
 	init(client);
 	if (t != nullptr) {
-		this->transport = t;
+		setTransport(t);
 	}
 }
 
@@ -70,12 +87,18 @@ Result ServerConnection::parseRequest(void* arg, uint8_t* data, uint16_t len) {
 	}
 
 	auto conn = static_cast<ServerConnection*>(arg);
+	int heldBefore = conn->currentRequest.getRecvHeld();
 	auto result = conn->currentRequest.parse((char*)data, len);
+	conn->recvHeld += conn->currentRequest.getRecvHeld() - heldBefore;
 	if (result == ERROR) {
 		conn->close();
 		return ERROR;
 	}
 
+	if (conn->pool != nullptr && conn->currentRequest.getAndClearForProcessing()) {
+		conn->pool->queueForProcessing(conn);
+	}
+
 	return OK;
 }
 
@@ -141,6 +164,42 @@ bool ServerConnection::writeData(const uint8_t* data, int len, int writeFlags) {
 
 }
 
+bool ServerConnection::writeSegments(const Transport::WriteSegment* segments, int count, int writeFlags) {
+	if (!isConnected()) {
+		return false;
+	}
+	bool locked = false;
+	if ((writeFlags & Transport::WriteFlagNoLock) == 0) {
+		LOCK_TCPIP_CORE();
+		locked = true;
+	}
+
+	int total = 0;
+	for (int i = 0; i < count; i++) {
+		total += segments[i].len;
+	}
+
+	bool result = true;
+	if (!sendQueue.empty() || total > transport->getAvailableSendBuffer()) {
+		for (int i = 0; i < count && result; i++) {
+			int flags = Transport::WriteFlagNoLock | (segments[i].copy ? 0 : Transport::WriteFlagZeroCopy);
+			result = writeData((const uint8_t*)segments[i].data, segments[i].len, flags);
+		}
+	}
+	else {
+		int written = transport->writev(segments, count);
+		if (written > 0) {
+			waitingForSendCompleteSize += written;
+		}
+		result = written == total;
+	}
+
+	if (locked) {
+		UNLOCK_TCPIP_CORE();
+	}
+	return result;
+}
+
 bool ServerConnection::sendNextFromQueue() {
 
 	ChunkForSend c = sendQueue.front();
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "ShardedServer.h"
+#include "log.h"
+
+using namespace SimpleHTTP;
+
+ShardedServer::ShardedServer() : shards(nullptr), shardCount(0), running(false)
+{
+}
+
+ShardedServer::~ShardedServer()
+{
+	stop();
+}
+
+Result ShardedServer::start(int port, int count)
+{
+	if (shards != nullptr) {
+		return ERROR;
+	}
+
+	if (count <= 0) {
+		count = std::thread::hardware_concurrency();
+		if (count <= 0) {
+			count = 1;
+		}
+	}
+
+	shards = new Shard[count];
+	shardCount = count;
+
+	//each shard listens from its own thread as an io_uring may only be used by the thread that first submits to it
+	std::promise<Result>* listening = new std::promise<Result>[shardCount];
+	running = true;
+	for (int i = 0; i < shardCount; i++) {
+		shards[i].thread = std::thread(run, this, &shards[i], port, &listening[i]);
+	}
+
+	Result result = OK;
+	for (int i = 0; i < shardCount; i++) {
+		if (listening[i].get_future().get() != OK) {
+			SHTTP_LOGE(__FUNCTION__, "shard %d failed to listen", i);
+			result = ERROR;
+		}
+	}
+	delete[] listening;
+
+	if (result != OK) {
+		stop();
+	}
+	return result;
+}
+
+void ShardedServer::stop()
+{
+	if (shards == nullptr) {
+		return;
+	}
+
+	running = false;
+	for (int i = 0; i < shardCount; i++) {
+		if (shards[i].thread.joinable()) {
+			shards[i].thread.join();
+		}
+	}
+
+	delete[] shards;
+	shards = nullptr;
+	shardCount = 0;
+}
+
+void ShardedServer::run(ShardedServer* owner, Shard* shard, int port, std::promise<Result>* listening)
+{
+	Result result = shard->server.listen(port, true);
+	listening->set_value(result);
+	if (result != OK) {
+		return;
+	}
+
+	while (owner->running.load(std::memory_order_relaxed)) {
+		shard->server.poll(pollTimeoutMs);
+		shard->pool.process();
+	}
+}
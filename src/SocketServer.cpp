@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SocketServer.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include "log.h"
+
+using namespace SimpleHTTP;
+using SimpleHTTP::Internal::SocketTransport;
+
+//backend independent parts of SocketServer, the event loops are in SocketServerEpoll.cpp and SocketServerUring.cpp
+
+Result SocketServer::openListenSocket(int port, bool reusePort)
+{
+	listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenFd < 0) {
+		return ERROR;
+	}
+
+	int on = 1;
+	setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if (reusePort && setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+		::close(listenFd);
+		listenFd = -1;
+		return ERROR;
+	}
+
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+
+	if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(listenFd, SOMAXCONN) != 0) {
+		SHTTP_LOGE(__FUNCTION__, "failed to listen on port %d errno %d", port, errno);
+		::close(listenFd);
+		listenFd = -1;
+		return ERROR;
+	}
+
+	return OK;
+}
+
+int SocketServer::getPort()
+{
+	sockaddr_in addr = {};
+	socklen_t size = sizeof(addr);
+	if (listenFd < 0 || getsockname(listenFd, (sockaddr*)&addr, &size) != 0) {
+		return -1;
+	}
+	return ntohs(addr.sin_port);
+}
+
+SocketTransport* SocketServer::acceptConnection(int fd)
+{
+	auto conn = pool->getFreeConnection();
+	if (conn == nullptr || freeTransports == nullptr) {
+		::close(fd);
+		return nullptr;
+	}
+
+	auto t = freeTransports;
+	freeTransports = t->nextFree;
+
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+	t->assign(this, fd, conn);
+	conn->init(nullptr, t);
+	return t;
+}
+
+void SocketServer::closeConnection(SocketTransport* t)
+{
+	auto conn = t->conn;
+	if (conn == nullptr) {
+		t->shutdown();
+		return;
+	}
+	conn->closeWithOutLocking();
+	conn->init(0);
+}
+
+void SocketServer::reportSent()
+{
+	while (sentReports != nullptr) {
+		auto t = sentReports;
+		sentReports = t->nextSentReport;
+		t->sentReportQueued = false;
+
+		int len = t->sentNotReported;
+		t->sentNotReported = 0;
+		if (!t->isOpen() || len == 0) {
+			continue;
+		}
+
+		auto conn = t->conn;
+		conn->sendCompleteCallback(len);
+
+		if (conn->closeOnceSent && conn->allSent()) {
+			conn->closeWithOutLocking();
+		}
+	}
+}
+
+void SocketServer::queueSentReport(SocketTransport* t)
+{
+	if (!t->sentReportQueued) {
+		t->sentReportQueued = true;
+		t->nextSentReport = sentReports;
+		sentReports = t;
+	}
+}
+
+void SocketServer::release(SocketTransport* t)
+{
+	t->fd = -1;
+	t->closing = false;
+	t->conn = nullptr;
+	t->nextFree = freeTransports;
+	freeTransports = t;
+}
+
+//the library uses this as a millisecond tick, applications may provide their own
+extern "C" __attribute__((weak)) uint32_t os_getUnixTime()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
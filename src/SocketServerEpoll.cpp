@@ -0,0 +1,321 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SocketServer.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <errno.h>
+
+using namespace SimpleHTTP;
+using SimpleHTTP::Internal::SocketTransport;
+
+static const uint32_t connectionEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+
+SocketServer::SocketServer(ConnectionPool* pool) : listenFd(-1), pool(pool), freeTransports(nullptr), sentReports(nullptr), epollFd(-1), closingCount(0)
+{
+	for (int i = ConnectionPool::maxConnections - 1; i >= 0; i--) {
+		release(&transports[i]);
+	}
+}
+
+SocketServer::~SocketServer()
+{
+	for (int i = 0; i < ConnectionPool::maxConnections; i++) {
+		if (transports[i].isOpen()) {
+			closeConnection(&transports[i]);
+		}
+		//nothing is polled after this so don't wait for the client
+		if (transports[i].closing) {
+			finishClose(&transports[i]);
+		}
+	}
+	if (listenFd >= 0) {
+		::close(listenFd);
+	}
+	if (epollFd >= 0) {
+		::close(epollFd);
+	}
+}
+
+Result SocketServer::listen(int port, bool reusePort)
+{
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (epollFd < 0 || openListenSocket(port, reusePort) != OK) {
+		return ERROR;
+	}
+
+	epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.ptr = nullptr;
+	if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) != 0) {
+		return ERROR;
+	}
+
+	return OK;
+}
+
+void SocketServer::poll(int timeoutMs)
+{
+	//anything written by the pools process() since the last call
+	reportSent();
+
+	epoll_event events[maxEventsPerPoll];
+	int count = epoll_wait(epollFd, events, maxEventsPerPoll, timeoutMs);
+	bool acceptPending = false;
+
+	for (int i = 0; i < count; i++) {
+		auto t = static_cast<SocketTransport*>(events[i].data.ptr);
+		if (t == nullptr) {
+			//accept after the batch so a transport freed in this batch can't pick up stale events
+			acceptPending = true;
+			continue;
+		}
+
+		if (t->closing) {
+			lingerClose(t);
+			continue;
+		}
+
+		if (!t->isOpen()) {
+			continue;
+		}
+
+		if (events[i].events & EPOLLOUT) {
+			if (!flush(t)) {
+				closeConnection(t);
+				continue;
+			}
+		}
+
+		if ((events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && !t->readPaused) {
+			readData(t);
+		}
+	}
+
+	//clients that haven't closed their side in time
+	if (closingCount > 0) {
+		uint32_t now = os_getUnixTime();
+		for (int i = 0; i < ConnectionPool::maxConnections; i++) {
+			auto t = &transports[i];
+			if (t->closing && (int32_t)(now - t->closeDeadline) >= 0) {
+				finishClose(t);
+			}
+		}
+	}
+
+	if (acceptPending) {
+		acceptConnections();
+	}
+
+	reportSent();
+}
+
+void SocketServer::acceptConnections()
+{
+	while (true) {
+		int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+
+		auto t = acceptConnection(fd);
+		if (t == nullptr) {
+			continue;
+		}
+
+		epoll_event ev = {};
+		ev.events = connectionEvents;
+		ev.data.ptr = t;
+		if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+			closeConnection(t);
+		}
+	}
+}
+
+void SocketServer::readData(SocketTransport* t)
+{
+	auto conn = t->conn;
+	while (t->isOpen() && t->conn == conn) {
+		auto size = recv(t->fd, recvBuffer, sizeof(recvBuffer), 0);
+		if (size < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				closeConnection(t);
+			}
+			return;
+		}
+
+		if (size == 0) {
+			closeConnection(t);
+			return;
+		}
+
+		conn->dataReceived(conn->dataReceivedArg, recvBuffer, size);
+		//the rest waits in the socket, so the client is slowed by TCP flow control rather than filling memory
+		if (t->conn == conn && conn->getRecvHeld() > 0) {
+			t->readPaused = true;
+			return;
+		}
+	}
+}
+
+void SocketServer::resumeRead(SocketTransport* t)
+{
+	//edge triggered, modifying the registration reports the socket again if data arrived while paused
+	epoll_event ev = {};
+	ev.events = connectionEvents;
+	ev.data.ptr = t;
+	epoll_ctl(epollFd, EPOLL_CTL_MOD, t->fd, &ev);
+}
+
+int SocketServer::sendDirect(SocketTransport* t, const uint8_t* data, int len)
+{
+	int offset = 0;
+	while (offset < len) {
+		auto sent = ::send(t->fd, data + offset, len - offset, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				return -1;
+			}
+			break;
+		}
+		offset += sent;
+	}
+	return offset;
+}
+
+int SocketServer::sendDirect(SocketTransport* t, const Transport::WriteSegment* segments, int count)
+{
+	//any segments past the first MaxIov are left for the send buffer
+	static const int MaxIov = 16;
+	iovec iov[MaxIov];
+	int iovCount = count < MaxIov ? count : MaxIov;
+	for (int i = 0; i < iovCount; i++) {
+		iov[i].iov_base = (void*)segments[i].data;
+		iov[i].iov_len = segments[i].len;
+	}
+
+	msghdr msg = {};
+	msg.msg_iov = iov;
+	msg.msg_iovlen = iovCount;
+	int offset = 0;
+	while (msg.msg_iovlen > 0) {
+		auto sent = ::sendmsg(t->fd, &msg, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				return -1;
+			}
+			break;
+		}
+		offset += sent;
+		//step past what was taken
+		while (msg.msg_iovlen > 0 && (size_t)sent >= msg.msg_iov->iov_len) {
+			sent -= msg.msg_iov->iov_len;
+			msg.msg_iov++;
+			msg.msg_iovlen--;
+		}
+		if (msg.msg_iovlen > 0) {
+			msg.msg_iov->iov_base = (uint8_t*)msg.msg_iov->iov_base + sent;
+			msg.msg_iov->iov_len -= sent;
+		}
+	}
+	return offset;
+}
+
+bool SocketServer::flush(SocketTransport* t)
+{
+	if (t->sendBufferUsed == 0) {
+		return true;
+	}
+
+	int sent = sendDirect(t, t->sendBuffer, t->sendBufferUsed);
+	if (sent < 0) {
+		return false;
+	}
+	if (sent > 0) {
+		t->sent(sent, true);
+	}
+	return true;
+}
+
+void SocketServer::closeTransport(SocketTransport* t)
+{
+	//like tcp_close() anything still queued goes out first, and closing with unread data would send a reset
+	t->closing = true;
+	t->closeDeadline = os_getUnixTime() + closeDrainTimeoutMs;
+	closingCount++;
+	lingerClose(t);
+}
+
+void SocketServer::lingerClose(SocketTransport* t)
+{
+	if (t->sendBufferUsed > 0) {
+		if (!flush(t)) {
+			finishClose(t);
+			return;
+		}
+		if (t->sendBufferUsed > 0) {
+			//EPOLLOUT sends the rest
+			return;
+		}
+	}
+	if (!t->writeShutdown) {
+		::shutdown(t->fd, SHUT_WR);
+		t->writeShutdown = true;
+	}
+
+	//edge triggered so read until there's nothing left, EPOLLIN comes back here for anything more
+	while (true) {
+		auto size = recv(t->fd, recvBuffer, sizeof(recvBuffer), 0);
+		if (size < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				return;
+			}
+			break;
+		}
+		t->drained += size;
+		if (size == 0 || t->drained > closeDrainLimit) {
+			break;
+		}
+	}
+	finishClose(t);
+}
+
+void SocketServer::finishClose(SocketTransport* t)
+{
+	::close(t->fd);
+	closingCount--;
+	release(t);
+}
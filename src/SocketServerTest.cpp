@@ -0,0 +1,425 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "SocketServer.h"
+#include "ShardedServer.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <string>
+#include <vector>
+using namespace SimpleHTTP;
+using std::string;
+
+//loopback tests, the client side is a non blocking socket driven from the same loop as the server
+static ConnectionPool socketPool;
+
+static int connectTo(int port, int sendBufferSize = 0) {
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	if (sendBufferSize > 0) {
+		setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize));
+	}
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+//runs the server and pool once
+static void serve(SocketServer* server) {
+	server->poll(1);
+	socketPool.process();
+}
+
+//runs the server and pool once, returns what the client has received since
+static string step(SocketServer* server, int fd) {
+	serve(server);
+	string received;
+	char buffer[4096];
+	ssize_t size;
+	while ((size = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+		received.append(buffer, size);
+	}
+	return received;
+}
+
+//steps until the client has a response ending in body
+static string exchange(SocketServer* server, int fd, const string& request, const char* body) {
+	send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+	string response;
+	for (int i = 0; i < 1000; i++) {
+		response += step(server, fd);
+		if (response.size() >= strlen(body) && response.compare(response.size() - strlen(body), string::npos, body) == 0) {
+			break;
+		}
+	}
+	return response;
+}
+
+static Request* helloRequest;
+
+static void helloHandler(Request* req, Response* resp) {
+	helloRequest = req;
+	resp->write("hello");
+}
+
+static const int bigSize = 256 * 1024;
+//written zero copy like EmbeddedFiles so it has to outlive the response
+static char bigBody[bigSize];
+
+static void bigHandler(Request* req, Response* resp) {
+	resp->addContentLengthHeader(bigSize);
+	resp->writeDirect(bigBody, bigSize);
+}
+
+TEST(SocketServer, RequestResponse) {
+	Router::addHandler(Request::GET, "/socket/hello", helloHandler);
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	string response = exchange(server.get(), fd, "GET /socket/hello HTTP/1.1\r\nHost: test\r\n\r\n", "hello");
+	ASSERT_EQ(response.find("HTTP/1.1 200 OK\r\n"), 0);
+	ASSERT_NE(response.find("Content-Length: 5\r\n"), string::npos);
+	ASSERT_EQ(response.substr(response.size() - 9), "\r\n\r\nhello");
+	close(fd);
+}
+
+TEST(SocketServer, KeepAliveReuse) {
+	Router::addHandler(Request::GET, "/socket/hello", helloHandler);
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	//both requests are served by the same connection, which stays open between them
+	helloRequest = nullptr;
+	string first = exchange(server.get(), fd, "GET /socket/hello HTTP/1.1\r\nHost: test\r\n\r\n", "hello");
+	ASSERT_EQ(first.find("HTTP/1.1 200 OK\r\n"), 0);
+	Request* firstRequest = helloRequest;
+	ASSERT_NE(firstRequest, nullptr);
+
+	helloRequest = nullptr;
+	string second = exchange(server.get(), fd, "GET /socket/hello HTTP/1.1\r\nHost: test\r\n\r\n", "hello");
+	ASSERT_EQ(second.find("HTTP/1.1 200 OK\r\n"), 0);
+	ASSERT_EQ(helloRequest, firstRequest);
+	close(fd);
+}
+
+TEST(SocketServer, Pipelined) {
+	Router::addHandler(Request::GET, "/socket/hello", helloHandler);
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	//well over SIMPLE_HTTP_MAX_PIPELINED_SIZE in one send, reading pauses and resumes rather than failing
+	const int count = 20;
+	string requests;
+	for (int i = 0; i < count; i++) {
+		requests += "GET /socket/hello HTTP/1.1\r\nHost: test\r\nUser-Agent: pipelined request\r\n\r\n";
+	}
+	send(fd, requests.data(), requests.size(), MSG_NOSIGNAL);
+	string response;
+	int responses = 0;
+	for (int i = 0; i < 1000 && responses < count; i++) {
+		response += step(server.get(), fd);
+		responses = 0;
+		for (size_t pos = response.find("\r\n\r\nhello"); pos != string::npos; pos = response.find("\r\n\r\nhello", pos + 1)) {
+			responses++;
+		}
+	}
+	ASSERT_EQ(responses, count);
+	close(fd);
+}
+
+TEST(SocketServer, PartialWrite) {
+	Router::addHandler(Request::GET, "/socket/big", bigHandler);
+	for (int i = 0; i < bigSize; i++) {
+		bigBody[i] = 'a' + i % 26;
+	}
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+	int receiveBufferSize = 16 * 1024;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+	//the client doesn't read so the response can't all be written at once, the rest is sent as the client drains it
+	string request = "GET /socket/big HTTP/1.1\r\nHost: test\r\n\r\n";
+	send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+	for (int i = 0; i < 50; i++) {
+		serve(server.get());
+	}
+	string response = step(server.get(), fd);
+	ASSERT_GT(response.size(), 0u);
+	ASSERT_LT(response.size(), (size_t)bigSize);
+
+	size_t headerEnd = response.find("\r\n\r\n");
+	ASSERT_NE(headerEnd, string::npos);
+	size_t total = headerEnd + 4 + bigSize;
+	for (int i = 0; i < 5000 && response.size() < total; i++) {
+		response += step(server.get(), fd);
+	}
+	ASSERT_EQ(response.size(), total);
+	ASSERT_NE(response.find("Content-Length: " + std::to_string(bigSize) + "\r\n"), string::npos);
+	for (int i = 0; i < bigSize; i++) {
+		ASSERT_EQ(response[headerEnd + 4 + i], (char)('a' + i % 26)) << "at " << i;
+	}
+	close(fd);
+}
+
+TEST(SocketServer, ConnectionClose) {
+	Router::addHandler(Request::GET, "/socket/hello", helloHandler);
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int inUse = socketPool.getConnectionsInUseCount();
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	//the response is sent in full before the server closes, the client then sees end of stream
+	string request = "GET /socket/hello HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n";
+	send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+	string response;
+	bool closed = false;
+	char buffer[4096];
+	for (int i = 0; i < 1000 && !closed; i++) {
+		serve(server.get());
+		ssize_t size;
+		while ((size = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+			response.append(buffer, size);
+		}
+		closed = size == 0;
+	}
+	ASSERT_TRUE(closed);
+	ASSERT_EQ(response.find("HTTP/1.1 200 OK\r\n"), 0);
+	ASSERT_NE(response.find("Connection: close\r\n"), string::npos);
+	ASSERT_EQ(response.substr(response.size() - 5), "hello");
+	ASSERT_EQ(socketPool.getConnectionsInUseCount(), inUse);
+	close(fd);
+}
+
+TEST(SocketServer, CloseWithUnreadData) {
+	Router::addHandler(Request::GET, "/socket/big", bigHandler);
+	for (int i = 0; i < bigSize; i++) {
+		bigBody[i] = 'a' + i % 26;
+	}
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	//data the server never reads is still waiting when it closes, the whole response must arrive rather than a reset
+	string request = "GET /socket/big HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n";
+	request.append(32 * 1024, 'x');
+	send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+	string response;
+	bool closed = false;
+	char buffer[4096];
+	for (int i = 0; i < 5000 && !closed; i++) {
+		serve(server.get());
+		ssize_t size;
+		while ((size = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+			response.append(buffer, size);
+		}
+		closed = size == 0;
+		ASSERT_FALSE(size < 0 && errno != EAGAIN && errno != EWOULDBLOCK) << "errno " << errno;
+	}
+	ASSERT_TRUE(closed);
+	size_t headerEnd = response.find("\r\n\r\n");
+	ASSERT_NE(headerEnd, string::npos);
+	ASSERT_EQ(response.size(), headerEnd + 4 + bigSize);
+	close(fd);
+}
+
+static void rejectHandler(Request* req, Response* resp) {
+	resp->writeHeader(Response::PayloadTooLarge);
+	resp->write("too large");
+}
+
+TEST(SocketServer, RejectedUpload) {
+	Router::addHandler(Request::POST, "/socket/reject", rejectHandler);
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort());
+	ASSERT_GE(fd, 0);
+
+	//the body is sent without waiting, the server closes without reading it and the client still gets the status
+	const int bodySize = 32 * 1024;
+	string request = "POST /socket/reject HTTP/1.1\r\nHost: test\r\nContent-Length: " + std::to_string(bodySize) + "\r\n\r\n";
+	request.append(bodySize, 'x');
+	size_t sent = 0;
+	string response;
+	bool closed = false;
+	char buffer[4096];
+	for (int i = 0; i < 5000 && !closed; i++) {
+		if (sent < request.size()) {
+			ssize_t size = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+			if (size > 0) {
+				sent += size;
+			}
+		}
+		serve(server.get());
+		ssize_t size;
+		while ((size = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+			response.append(buffer, size);
+		}
+		closed = size == 0;
+		ASSERT_FALSE(size < 0 && errno != EAGAIN && errno != EWOULDBLOCK) << "errno " << errno;
+	}
+	ASSERT_TRUE(closed);
+	ASSERT_EQ(response.find("HTTP/1.1 413 Payload Too Large\r\n"), 0);
+	ASSERT_NE(response.find("Connection: close\r\n"), string::npos);
+	ASSERT_EQ(response.substr(response.size() - 9), "too large");
+	close(fd);
+}
+
+static std::mutex shardThreadsLock;
+static std::set<std::thread::id> shardThreads;
+
+static void shardHandler(Request* req, Response* resp) {
+	{
+		std::lock_guard<std::mutex> lock(shardThreadsLock);
+		shardThreads.insert(std::this_thread::get_id());
+	}
+	resp->write("shard");
+}
+
+TEST(SocketServer, Sharded) {
+	Router::addHandler(Request::GET, "/socket/shard", shardHandler);
+	//a free port for all the shards to share
+	int port;
+	{
+		std::unique_ptr<SocketServer> probe(new SocketServer(&socketPool));
+		ASSERT_EQ(probe->listen(0), OK);
+		port = probe->getPort();
+	}
+	ShardedServer sharded;
+	ASSERT_EQ(sharded.start(port, 2), OK);
+	ASSERT_EQ(sharded.getShardCount(), 2);
+
+	//the kernel spreads connections across the shards, each is served on its shard's thread
+	shardThreads.clear();
+	const int clients = 16;
+	for (int i = 0; i < clients; i++) {
+		int fd = connectTo(port);
+		ASSERT_GE(fd, 0);
+		string request = "GET /socket/shard HTTP/1.1\r\nHost: test\r\n\r\n";
+		send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+		string response;
+		char buffer[4096];
+		for (int j = 0; j < 1000 && response.find("shard") == string::npos; j++) {
+			ssize_t size = recv(fd, buffer, sizeof(buffer), 0);
+			if (size > 0) {
+				response.append(buffer, size);
+			}
+			else {
+				usleep(1000);
+			}
+		}
+		ASSERT_EQ(response.find("HTTP/1.1 200 OK\r\n"), 0);
+		close(fd);
+	}
+	sharded.stop();
+	ASSERT_EQ(shardThreads.size(), 2u);
+	ASSERT_EQ(shardThreads.count(std::this_thread::get_id()), 0u);
+}
+
+static int uploadTaken;
+static int uploadMaxOffered;
+static bool uploadAccepting;
+
+static void uploadHandler(Request* req, Response* resp) {
+	req->setBodyHandler([](Request* request, const char* data, int size) {
+		if (size > uploadMaxOffered) {
+			uploadMaxOffered = size;
+		}
+		if (!uploadAccepting) {
+			return 0;
+		}
+		uploadTaken += size;
+		return size;
+	}, [](Request* request, Response* response) {
+		response->write("done");
+	}, nullptr);
+}
+
+TEST(SocketServer, BodyBackpressure) {
+	Router::addHandler(Request::POST, "/socket/upload", uploadHandler);
+	//the transports send buffers make this too big for the stack
+	std::unique_ptr<SocketServer> server(new SocketServer(&socketPool));
+	ASSERT_EQ(server->listen(0), OK);
+	int fd = connectTo(server->getPort(), 64 * 1024);
+	ASSERT_GE(fd, 0);
+
+	const int bodySize = 4 * 1024 * 1024;
+	string request = "POST /socket/upload HTTP/1.1\r\nContent-Length: " + std::to_string(bodySize) + "\r\n\r\n";
+	request.append(bodySize, 'x');
+	size_t sent = 0;
+	auto sendMore = [&]() {
+		ssize_t size = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+		if (size > 0) {
+			sent += size;
+		}
+	};
+
+	//the handler takes nothing so the server stops reading and the client stalls
+	//what was read before the handler started streaming stays held, it doesn't grow after that
+	uploadTaken = 0;
+	uploadMaxOffered = 0;
+	uploadAccepting = false;
+	for (int i = 0; i < 100; i++) {
+		sendMore();
+		step(server.get(), fd);
+	}
+	int held = uploadMaxOffered;
+	for (int i = 0; i < 100; i++) {
+		sendMore();
+		step(server.get(), fd);
+	}
+	ASSERT_GT(held, 0);
+	ASSERT_EQ(uploadMaxOffered, held);
+	ASSERT_LT(sent, request.size());
+
+	uploadAccepting = true;
+	string response;
+	for (int i = 0; i < 5000 && response.find("done") == string::npos; i++) {
+		sendMore();
+		response += step(server.get(), fd);
+	}
+	ASSERT_EQ(sent, request.size());
+	ASSERT_EQ(uploadTaken, bodySize);
+	ASSERT_NE(response.find("HTTP/1.1 200 OK"), string::npos);
+	close(fd);
+}
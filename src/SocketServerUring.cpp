@@ -0,0 +1,398 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SocketServer.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <errno.h>
+#include "log.h"
+
+using namespace SimpleHTTP;
+using SimpleHTTP::Internal::SocketTransport;
+
+namespace {
+	//completions carry the transport index and generation so ones for a reused transport are dropped
+	enum Operation : uint8_t {
+		OpAccept = 1,
+		OpRecv,
+		OpSend,
+		OpShutdown,
+		OpClose,
+		OpCancel,
+		//closeDrainTimeout has passed since the transport started closing
+		OpCloseTimeout
+	};
+
+	inline uint64_t toUserData(int index, uint32_t generation, Operation op) {
+		return ((uint64_t)index << 40) | ((uint64_t)generation << 8) | op;
+	}
+}
+
+const __kernel_timespec SocketServer::closeDrainTimeout = { closeDrainTimeoutMs / 1000, (closeDrainTimeoutMs % 1000) * 1000000 };
+
+SocketServer::SocketServer(ConnectionPool* pool) : listenFd(-1), pool(pool), freeTransports(nullptr), sentReports(nullptr)
+{
+	for (int i = ConnectionPool::maxConnections - 1; i >= 0; i--) {
+		release(&transports[i]);
+	}
+}
+
+SocketServer::~SocketServer()
+{
+	//tearing down the ring cancels anything in flight, so the sockets are closed directly
+	ring.destroy();
+	for (int i = 0; i < ConnectionPool::maxConnections; i++) {
+		auto t = &transports[i];
+		if (t->fd < 0) {
+			continue;
+		}
+		auto conn = t->conn;
+		::close(t->fd);
+		release(t);
+		if (conn != nullptr) {
+			conn->runFreeSessionHandler();
+			conn->dataReceived(conn->dataReceivedArg, 0, 0);
+			conn->init(0);
+		}
+	}
+	if (listenFd >= 0) {
+		::close(listenFd);
+	}
+}
+
+Result SocketServer::listen(int port, bool reusePort)
+{
+	int result = ring.init(ringEntries);
+	if (result < 0) {
+		SHTTP_LOGE(__FUNCTION__, "io_uring setup failed %d", result);
+		return ERROR;
+	}
+
+	result = ring.setupBufferRing(recvBufferGroup, recvBufferCount, recvBufferSize);
+	if (result < 0) {
+		SHTTP_LOGE(__FUNCTION__, "io_uring buffer ring setup failed %d", result);
+		return ERROR;
+	}
+
+	if (openListenSocket(port, reusePort) != OK) {
+		return ERROR;
+	}
+
+	armAccept();
+	return OK;
+}
+
+void SocketServer::poll(int timeoutMs)
+{
+	//anything written by the pools process() since the last call
+	reportSent();
+
+	//one syscall submits the sends queued since the last poll and waits for completions
+	ring.submitAndWait(1, timeoutMs);
+
+	io_uring_cqe* cqe;
+	while ((cqe = ring.peekCqe()) != nullptr) {
+		io_uring_cqe c = *cqe;
+		ring.cqeSeen();
+		handleCompletion(&c);
+	}
+
+	reportSent();
+}
+
+void SocketServer::armAccept()
+{
+	auto sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		return;
+	}
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = listenFd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->accept_flags = SOCK_CLOEXEC;
+	sqe->user_data = toUserData(0, 0, OpAccept);
+}
+
+void SocketServer::armRecv(SocketTransport* t)
+{
+	auto sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		return;
+	}
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = t->fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = recvBufferGroup;
+	sqe->user_data = toUserData(t - transports, t->generation, OpRecv);
+	t->recvArmed = true;
+}
+
+void SocketServer::cancelRecv(SocketTransport* t)
+{
+	auto sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		return;
+	}
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = toUserData(t - transports, t->generation, OpRecv);
+	sqe->user_data = toUserData(t - transports, t->generation, OpCancel);
+}
+
+void SocketServer::resumeRead(SocketTransport* t)
+{
+	//otherwise the recv being cancelled is armed again when its last completion arrives
+	if (!t->recvArmed) {
+		armRecv(t);
+	}
+}
+
+void SocketServer::submitSend(SocketTransport* t)
+{
+	auto sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		return;
+	}
+	sqe->opcode = IORING_OP_SEND;
+	sqe->fd = t->fd;
+	sqe->addr = (uint64_t)t->sendBuffer;
+	sqe->len = t->sendBufferUsed;
+	sqe->msg_flags = MSG_NOSIGNAL;
+	sqe->user_data = toUserData(t - transports, t->generation, OpSend);
+	t->sendInFlight = t->sendBufferUsed;
+}
+
+void SocketServer::submitClose(SocketTransport* t)
+{
+	//the rest of the buffer first, this runs again when the send completes
+	if (t->sendBufferUsed > 0) {
+		submitSend(t);
+		return;
+	}
+
+	int index = t - transports;
+	auto sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		finishClose(t);
+		return;
+	}
+	sqe->opcode = IORING_OP_SHUTDOWN;
+	sqe->fd = t->fd;
+	sqe->len = SHUT_WR;
+	sqe->user_data = toUserData(index, t->generation, OpShutdown);
+	t->writeShutdown = true;
+
+	//closing with unread data would send a reset, so what arrives is discarded until the client closes
+	if (!t->recvArmed) {
+		armRecv(t);
+	}
+	sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		finishClose(t);
+		return;
+	}
+	sqe->opcode = IORING_OP_TIMEOUT;
+	sqe->fd = -1;
+	sqe->addr = (uint64_t)&closeDrainTimeout;
+	sqe->len = 1;
+	sqe->user_data = toUserData(index, t->generation, OpCloseTimeout);
+}
+
+void SocketServer::finishClose(SocketTransport* t)
+{
+	if (t->closeSubmitted) {
+		return;
+	}
+	t->closeSubmitted = true;
+	int index = t - transports;
+
+	auto sqe = ring.getSqe();
+	if (sqe != nullptr) {
+		//wakes the multishot recv so it stops holding the socket open
+		sqe->opcode = IORING_OP_SHUTDOWN;
+		sqe->fd = t->fd;
+		sqe->len = SHUT_RDWR;
+		sqe->flags = IOSQE_IO_HARDLINK;
+		sqe->user_data = toUserData(index, t->generation, OpShutdown);
+	}
+
+	sqe = ring.getSqe();
+	if (sqe == nullptr) {
+		SHTTP_LOGE(__FUNCTION__, "submission queue full");
+		::close(t->fd);
+		release(t);
+		return;
+	}
+	sqe->opcode = IORING_OP_CLOSE;
+	sqe->fd = t->fd;
+	sqe->user_data = toUserData(index, t->generation, OpClose);
+}
+
+void SocketServer::handleCompletion(const io_uring_cqe* cqe)
+{
+	auto op = (Operation)(cqe->user_data & 0xff);
+	auto generation = (uint32_t)(cqe->user_data >> 8);
+	auto t = &transports[cqe->user_data >> 40];
+	bool current = t->generation == generation;
+
+	switch (op) {
+	case OpAccept:
+		if (cqe->res >= 0) {
+			auto accepted = acceptConnection(cqe->res);
+			if (accepted != nullptr) {
+				armRecv(accepted);
+			}
+		}
+		if (!(cqe->flags & IORING_CQE_F_MORE)) {
+			armAccept();
+		}
+		break;
+	case OpRecv:
+	{
+		bool hasBuffer = cqe->flags & IORING_CQE_F_BUFFER;
+		uint16_t bufferId = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+
+		if (!current || !t->isOpen()) {
+			if (hasBuffer) {
+				ring.recycleBuffer(bufferId);
+			}
+			if (current && t->closing && t->fd >= 0) {
+				//discarded while closing, until the client closes its side or it has sent too much
+				if (!(cqe->flags & IORING_CQE_F_MORE)) {
+					t->recvArmed = false;
+				}
+				if (cqe->res > 0) {
+					t->drained += cqe->res;
+				}
+				bool ended = cqe->res == 0 || (cqe->res < 0 && cqe->res != -ENOBUFS && cqe->res != -ECANCELED);
+				if (t->drained > closeDrainLimit || (ended && t->writeShutdown)) {
+					finishClose(t);
+				}
+				else if (!t->recvArmed && !ended && t->writeShutdown && !t->closeSubmitted) {
+					armRecv(t);
+				}
+			}
+			break;
+		}
+
+		if (!(cqe->flags & IORING_CQE_F_MORE)) {
+			t->recvArmed = false;
+		}
+
+		if (cqe->res > 0 && hasBuffer) {
+			auto conn = t->conn;
+			conn->dataReceived(conn->dataReceivedArg, ring.getBuffer(bufferId), cqe->res);
+			ring.recycleBuffer(bufferId);
+			if (!t->isOpen() || t->generation != generation) {
+				break;
+			}
+			if (conn->getRecvHeld() > 0) {
+				//stop receiving until recved(), the client is then slowed by TCP flow control
+				if (!t->readPaused) {
+					t->readPaused = true;
+					if (t->recvArmed) {
+						cancelRecv(t);
+					}
+				}
+			}
+			else if (!t->recvArmed && !t->readPaused) {
+				armRecv(t);
+			}
+		}
+		else if (cqe->res == -ENOBUFS || cqe->res == -ECANCELED) {
+			//every provided buffer was in use (they have been recycled since) or paused by cancelRecv()
+			if (!t->recvArmed && !t->readPaused) {
+				armRecv(t);
+			}
+		}
+		else {
+			closeConnection(t);
+		}
+		break;
+	}
+	case OpSend:
+		if (!current) {
+			break;
+		}
+		t->sendInFlight = 0;
+		if (cqe->res < 0) {
+			if (t->closing) {
+				finishClose(t);
+			}
+			else {
+				closeConnection(t);
+			}
+			break;
+		}
+		t->sent(cqe->res, true);
+		if (t->closing) {
+			submitClose(t);
+			break;
+		}
+		flush(t);
+		break;
+	case OpCloseTimeout:
+		if (current && t->closing && t->fd >= 0) {
+			finishClose(t);
+		}
+		break;
+	case OpClose:
+		if (current) {
+			release(t);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+int SocketServer::sendDirect(SocketTransport*, const uint8_t*, int)
+{
+	//everything goes through the send buffer so sends can be batched in to the next submit
+	return 0;
+}
+
+int SocketServer::sendDirect(SocketTransport*, const Transport::WriteSegment*, int)
+{
+	//copied in to the send buffer as one block, see above
+	return 0;
+}
+
+bool SocketServer::flush(SocketTransport* t)
+{
+	if (t->sendInFlight == 0 && t->sendBufferUsed > 0 && t->isOpen()) {
+		submitSend(t);
+	}
+	return true;
+}
+
+void SocketServer::closeTransport(SocketTransport* t)
+{
+	t->closing = true;
+	if (t->sendInFlight == 0) {
+		submitClose(t);
+	}
+}
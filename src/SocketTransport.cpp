@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SocketTransport.h"
+#include "SocketServer.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+
+using namespace SimpleHTTP;
+using SimpleHTTP::Internal::SocketTransport;
+
+void SocketTransport::assign(SocketServer* server, int socketFd, ServerConnection* connection)
+{
+	owner = server;
+	fd = socketFd;
+	conn = connection;
+	closing = false;
+	readPaused = false;
+	recvArmed = false;
+	writeShutdown = false;
+	drained = 0;
+	closeSubmitted = false;
+	generation++;
+	sendBufferUsed = 0;
+	sendInFlight = 0;
+	sentNotReported = 0;
+}
+
+void SocketTransport::sent(int size, bool fromBuffer)
+{
+	if (fromBuffer) {
+		memmove(sendBuffer, sendBuffer + size, sendBufferUsed - size);
+		sendBufferUsed -= size;
+	}
+	sentNotReported += size;
+	owner->queueSentReport(this);
+}
+
+void SocketTransport::recved(int len)
+{
+	if (readPaused && isOpen() && conn->getRecvHeld() == 0) {
+		readPaused = false;
+		owner->resumeRead(this);
+	}
+}
+
+int SocketTransport::write(const void* dataptr, u16_t len, uint8_t apiflags)
+{
+	if (!isOpen()) {
+		return ERR_CONN;
+	}
+
+	if (len > sendBufferSize - sendBufferUsed) {
+		return ERR_MEM;
+	}
+
+	auto data = (const uint8_t*)dataptr;
+	int offset = 0;
+	//nothing queued ahead of this data so the backend may take it directly and only the remainder is copied
+	if (sendBufferUsed == 0 && (apiflags & WriteFlagNoFlush) == 0) {
+		offset = owner->sendDirect(this, data, len);
+		if (offset < 0) {
+			return ERR_CONN;
+		}
+		if (offset > 0) {
+			sent(offset, false);
+		}
+	}
+
+	if (offset < len) {
+		memcpy(sendBuffer + sendBufferUsed, data + offset, len - offset);
+		sendBufferUsed += len - offset;
+		if ((apiflags & WriteFlagNoFlush) == 0 && !owner->flush(this)) {
+			return ERR_CONN;
+		}
+	}
+
+	return len;
+}
+
+int SocketTransport::writev(const WriteSegment* segments, int count)
+{
+	if (!isOpen()) {
+		return ERR_CONN;
+	}
+
+	int total = 0;
+	for (int i = 0; i < count; i++) {
+		total += segments[i].len;
+	}
+	if (total > sendBufferSize - sendBufferUsed) {
+		return ERR_MEM;
+	}
+
+	int offset = 0;
+	if (sendBufferUsed == 0) {
+		offset = owner->sendDirect(this, segments, count);
+		if (offset < 0) {
+			return ERR_CONN;
+		}
+		if (offset > 0) {
+			sent(offset, false);
+		}
+	}
+
+	if (offset < total) {
+		//copy what the kernel didn't take
+		for (int i = 0; i < count; i++) {
+			int len = segments[i].len;
+			if (offset >= len) {
+				offset -= len;
+				continue;
+			}
+			memcpy(sendBuffer + sendBufferUsed, (const uint8_t*)segments[i].data + offset, len - offset);
+			sendBufferUsed += len - offset;
+			offset = 0;
+		}
+		if (!owner->flush(this)) {
+			return ERR_CONN;
+		}
+	}
+
+	return total;
+}
+
+err_t SocketTransport::shutdown()
+{
+	if (!isOpen()) {
+		return ERR_CONN;
+	}
+	conn = nullptr;
+	owner->closeTransport(this);
+	return ERR_OK;
+}
+
+bool SocketTransport::getRemoteIPAddress(char* buf, int buflen)
+{
+	sockaddr_storage addr;
+	socklen_t addrLen = sizeof(addr);
+	if (!isOpen() || getpeername(fd, (sockaddr*)&addr, &addrLen) != 0) {
+		return false;
+	}
+
+	switch (addr.ss_family) {
+	case AF_INET:
+		return inet_ntop(AF_INET, &((sockaddr_in*)&addr)->sin_addr, buf, buflen) != nullptr;
+	case AF_INET6:
+		return inet_ntop(AF_INET6, &((sockaddr_in6*)&addr)->sin6_addr, buf, buflen) != nullptr;
+	}
+	return false;
+}
@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TimerWheel.h"
+#include <string.h>
+
+using namespace SimpleHTTP;
+
+TimerWheel::TimerWheel(uint32_t tickMs) : tickMs(tickMs), currentTick(0), lastTime(0), started(false)
+{
+	memset(slots, 0, sizeof(slots));
+}
+
+void TimerWheel::schedule(Timer* timer, uint32_t delayMs)
+{
+	cancel(timer);
+	//round up and add a tick as the current tick is already part way through
+	uint32_t ticks = (delayMs + tickMs - 1) / tickMs + 1;
+	if (ticks > maxDelayTicks) {
+		ticks = maxDelayTicks;
+	}
+	timer->expires = currentTick + ticks;
+	insert(timer);
+}
+
+void TimerWheel::cancel(Timer* timer)
+{
+	if (timer->isScheduled()) {
+		unlink(timer);
+	}
+}
+
+void TimerWheel::insert(Timer* timer)
+{
+	uint32_t delta = timer->expires - currentTick;
+	int level = 0;
+	while (level < levels - 1 && delta >= (1u << (slotBits * (level + 1)))) {
+		level++;
+	}
+
+	Timer** head = &slots[level][(timer->expires >> (slotBits * level)) & slotMask];
+
+	timer->next = *head;
+	if (timer->next != nullptr) {
+		timer->next->pprev = &timer->next;
+	}
+	timer->pprev = head;
+	*head = timer;
+}
+
+void TimerWheel::unlink(Timer* timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next != nullptr) {
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = nullptr;
+	timer->pprev = nullptr;
+}
+
+void TimerWheel::cascade(int level)
+{
+	Timer** head = &slots[level][(currentTick >> (slotBits * level)) & slotMask];
+	Timer* timer = *head;
+	*head = nullptr;
+	while (timer != nullptr) {
+		Timer* next = timer->next;
+		timer->pprev = nullptr;
+		insert(timer);
+		timer = next;
+	}
+}
+
+void TimerWheel::runTick()
+{
+	currentTick++;
+	//as each level wraps re-file the next slot of the level above, its timers land on lower levels by what remains
+	for (int level = 1; level < levels; level++) {
+		if ((currentTick & ((1u << (slotBits * level)) - 1)) != 0) {
+			break;
+		}
+		cascade(level);
+	}
+
+	Timer** head = &slots[0][currentTick & slotMask];
+	while (*head != nullptr) {
+		Timer* timer = *head;
+		unlink(timer);
+		timer->callback(timer->arg);
+	}
+}
+
+void TimerWheel::advance(uint32_t now)
+{
+	if (!started) {
+		started = true;
+		lastTime = now;
+		return;
+	}
+
+	while (now - lastTime >= tickMs) {
+		lastTime += tickMs;
+		runTick();
+	}
+}
@@ -0,0 +1,78 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "TimerWheel.h"
+using SimpleHTTP::TimerWheel;
+
+static void countFired(void* arg) {
+	(*static_cast<int*>(arg))++;
+}
+
+TEST(TimerWheel, FiresAfterDelay) {
+	TimerWheel wheel(10);
+	int fired = 0;
+	TimerWheel::Timer t;
+	t.init(countFired, &fired);
+	wheel.advance(1000);
+	wheel.schedule(&t, 50);
+	wheel.advance(1040);
+	ASSERT_EQ(fired, 0);
+	wheel.advance(1070);
+	ASSERT_EQ(fired, 1);
+	ASSERT_FALSE(t.isScheduled());
+}
+
+TEST(TimerWheel, CascadesLongDelays) {
+	TimerWheel wheel(1);
+	int fired[3] = { 0 };
+	TimerWheel::Timer t[3];
+	uint32_t delays[3] = { 300, 5000, 60000 };
+	wheel.advance(0);
+	for (int i = 0; i < 3; i++) {
+		t[i].init(countFired, &fired[i]);
+		wheel.schedule(&t[i], delays[i]);
+	}
+	for (uint32_t now = 1; now <= 60002; now++) {
+		wheel.advance(now);
+		for (int i = 0; i < 3; i++) {
+			//never early and never more than a tick late
+			ASSERT_EQ(fired[i], now > delays[i] ? 1 : 0) << "timer " << i << " at " << now;
+		}
+	}
+}
+
+TEST(TimerWheel, CancelAndReschedule) {
+	TimerWheel wheel(10);
+	int fired = 0;
+	TimerWheel::Timer t;
+	t.init(countFired, &fired);
+	wheel.advance(0);
+	wheel.schedule(&t, 100);
+	wheel.cancel(&t);
+	wheel.advance(500);
+	ASSERT_EQ(fired, 0);
+
+	wheel.schedule(&t, 100);
+	wheel.schedule(&t, 300);
+	wheel.advance(600);
+	ASSERT_EQ(fired, 0);
+	wheel.advance(820);
+	ASSERT_EQ(fired, 1);
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "utility.h"
+#include <chrono>
+#include <string>
+#include <string.h>
+using SimpleHTTP::Utility;
+using std::string;
+
+static string format(uint32_t value, int base, int size = 16) {
+	char buffer[16];
+	int length = base == Utility::DecBase ? Utility::formatDecimal(value, buffer, size) : Utility::formatHex(value, buffer, size);
+	return string(buffer, length);
+}
+
+TEST(Utility, formatDecimal) {
+	ASSERT_EQ(format(0, 10), "0");
+	ASSERT_EQ(format(7, 10), "7");
+	ASSERT_EQ(format(10, 10), "10");
+	ASSERT_EQ(format(99, 10), "99");
+	ASSERT_EQ(format(100, 10), "100");
+	ASSERT_EQ(format(123456789, 10), "123456789");
+	ASSERT_EQ(format(1000000000, 10), "1000000000");
+	ASSERT_EQ(format(4294967295u, 10), "4294967295");
+	for (uint32_t i = 0; i < 100000; i += 7) {
+		ASSERT_EQ(format(i, 10), std::to_string(i));
+	}
+	//doesn't fit
+	ASSERT_EQ(format(4294967295u, 10, 9), "");
+	ASSERT_EQ(format(99, 10, 2), "99");
+}
+
+TEST(Utility, formatHex) {
+	ASSERT_EQ(format(0, 16), "0");
+	ASSERT_EQ(format(0xA, 16), "A");
+	ASSERT_EQ(format(0x17E, 16), "17E");
+	ASSERT_EQ(format(0xFFFF, 16), "FFFF");
+	ASSERT_EQ(format(0x12345, 16), "12345");
+	ASSERT_EQ(format(0xFFFFFFF, 16), "FFFFFFF");
+	ASSERT_EQ(format(0x10000000, 16), "10000000");
+	ASSERT_EQ(format(0xFFFFFFFF, 16), "FFFFFFFF");
+	ASSERT_EQ(format(0x12345, 16, 4), "");
+
+	char buffer[12];
+	ASSERT_EQ(Utility::toASCII(-42, buffer, Utility::DecBase, sizeof(buffer)), 3);
+	ASSERT_EQ(string(buffer, 3), "-42");
+	ASSERT_EQ(Utility::toASCII(5, buffer, 2, sizeof(buffer)), 3);
+	ASSERT_EQ(string(buffer, 3), "101");
+	ASSERT_EQ(Utility::toASCII(1234567890, buffer, Utility::DecBase, 4), 0);
+	ASSERT_EQ(Utility::toASCII(INT32_MIN, buffer, Utility::DecBase, sizeof(buffer)), 11);
+	ASSERT_EQ(string(buffer, 11), "-2147483648");
+}
+
+//the divide per digit version toASCII replaced
+static int divideEachDigit(int value, char* buffer, int base) {
+	static const char lookup[] = "0123456789ABCDEF";
+	char tmp[10];
+	int index = sizeof(tmp);
+	do {
+		tmp[--index] = lookup[value % base];
+		value /= base;
+	} while (value != 0);
+	memcpy(buffer, tmp + index, sizeof(tmp) - index);
+	return sizeof(tmp) - index;
+}
+
+//timing only, run with --gtest_also_run_disabled_tests --gtest_filter=Utility.*Benchmark
+TEST(Utility, DISABLED_formatBenchmark) {
+	const int iterations = 2000000;
+	char buffer[16];
+	volatile int sink = 0;
+	auto time = [&](auto formatter) {
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; i++) {
+			//mostly Content-Length sized values
+			sink = sink + formatter((uint32_t)i * 2654435761u % 1000000, buffer);
+		}
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+	};
+
+	double oldDecimal = time([](uint32_t v, char* b) { return divideEachDigit(v, b, 10); });
+	double newDecimal = time([](uint32_t v, char* b) { return Utility::formatDecimal(v, b, 16); });
+	double oldHex = time([](uint32_t v, char* b) { return divideEachDigit(v, b, 16); });
+	double newHex = time([](uint32_t v, char* b) { return Utility::formatHex(v, b, 16); });
+	printf("decimal %.1fns -> %.1fns, hex %.1fns -> %.1fns per value\n", oldDecimal, newDecimal, oldHex, newHex);
+}
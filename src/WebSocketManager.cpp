@@ -21,6 +21,7 @@
 #include "Request.h"
 #include "Response.h"
 #include "log.h"
+#include "utility.h"
 #include "libsha1.h"
 extern "C" {
 #include "cencode.h"
@@ -30,14 +31,14 @@ using namespace SimpleHTTP;
 
 void WebsocketManager::upgradeHandler(Request* req, Response* resp)
 {
-	auto connHeader = req->headers["CONNECTION"];
-	if (connHeader.find("Upgrade") == -1) {
+	auto connHeader = req->header(HeaderId::Connection);
+	if (!Utility::contains(connHeader, "Upgrade")) {
 		resp->writeHeader(Response::BadRequest);
 		return;
 	}
 
-	auto keyHeader = req->headers["SEC-WEBSOCKET-KEY"];
-	if (keyHeader.empty()) {
+	auto keyHeader = req->header(HeaderId::SecWebSocketKey);
+	if (keyHeader.size == 0) {
 		resp->writeHeader(Response::BadRequest);
 		return;
 	}
@@ -53,7 +54,7 @@ void WebsocketManager::upgradeHandler(Request* req, Response* resp)
 	const int headerNameSize = sizeof("Sec-WebSocket-Accept: ") - 1;
 	char buffer[100] = "";
 
-	int len = acceptKey(keyHeader, buffer);
+	int len = acceptKey(string(keyHeader.value, keyHeader.size), buffer);
 	buffer[len] = 0;
 
 	resp->writeHeaderLine("Sec-WebSocket-Accept", buffer);
@@ -63,10 +64,17 @@ void WebsocketManager::upgradeHandler(Request* req, Response* resp)
 	auto client = resp->hijackConnection();
 	//setup the mapping from ServerConnection to the WebSocket and back
 
-	connections[wsIndex].assign(client);
-	client->dataReceivedArg = &connections[wsIndex];
+	auto ws = &connections[wsIndex];
+	ws->assign(client);
+	client->dataReceivedArg = ws;
 	client->dataReceived = dataReceivedHandler;
-	connections[wsIndex].lastPingSent = os_getUnixTime();
+	ws->lastPingSent = os_getUnixTime();
+
+	ws->pingInterval = pingInterval;
+	ws->pongTimeout = pongTimeout;
+	ws->closeTimeout = closeTimeout;
+	ws->pingTimer.init(pingTimerExpired, ws);
+	timers.schedule(&ws->pingTimer, ws->pingInterval);
 
 }
 
@@ -145,6 +153,8 @@ void WebsocketManager::process() {
 		lastConnectionsInUse = connCountInUse;
 	}
 
+	timers.advance(os_getUnixTime());
+
 	for (int i = 0; i < poolSize; i++) {
 		if (connections[i].isInUse()) {
 			auto ws = &connections[i];
@@ -179,28 +189,43 @@ void WebsocketManager::process() {
 				}
 
 			}
-			else if (false || os_getUnixTime() - ws->lastPingSent > 15000) {
-				SHTTP_LOGD(__FUNCTION__, "ws check");
-				if ((ws->lastPongReceived != 0 && os_getUnixTime() - ws->lastPongReceived > 60000) || (ws->lastPongReceived == 0 && os_getUnixTime() - ws->getConnection()->lastRequestTime > 60000)) {
-					SHTTP_LOGE(__FUNCTION__, "ws close no pong");
-					ws->getConnection()->close();
-					return;
-				}
-				SHTTP_LOGD(__FUNCTION__, "pinging connect %d", i);
-				if (ws->writeFrame(Websocket::FrameTypePing, nullptr) == ERROR) {
-					SHTTP_LOGE(__FUNCTION__, "closing due to ping error");
-					ws->getConnection()->close();
-				}
-				ws->lastPingSent = os_getUnixTime();
-			}
-			else if (ws->lastPongReceived != 0 && os_getUnixTime() - ws->lastPingSent > 30000 && !ws->isCloseRequestedByServer()) {
-				SHTTP_LOGE(__FUNCTION__, "pong timeout %d %d", (int)ws->lastPingSent, (int)ws->lastPongReceived);
-				ws->sendCloseFrame(66);
-			}
 		}
 	}
 }
 
+void WebsocketManager::pingTimerExpired(void* arg) {
+	//the timer is not cancelled when a socket is released, only rescheduled on reuse
+	auto ws = static_cast<Websocket*>(arg);
+	if (!ws->isInUse()) {
+		return;
+	}
+
+	auto now = os_getUnixTime();
+	SHTTP_LOGD(__FUNCTION__, "ws check");
+	if ((ws->lastPongReceived != 0 && now - ws->lastPongReceived > ws->closeTimeout) || (ws->lastPongReceived == 0 && now - ws->getConnection()->lastRequestTime > ws->closeTimeout)) {
+		SHTTP_LOGE(__FUNCTION__, "ws close no pong");
+		ws->getConnection()->close();
+		return;
+	}
+
+	if (ws->lastPongReceived != 0 && now - ws->lastPongReceived > ws->pongTimeout && !ws->isCloseRequestedByServer()) {
+		SHTTP_LOGE(__FUNCTION__, "pong timeout %d %d", (int)ws->lastPingSent, (int)ws->lastPongReceived);
+		ws->sendCloseFrame(66);
+	}
+	else {
+		SHTTP_LOGD(__FUNCTION__, "pinging connection");
+		if (ws->writeFrame(Websocket::FrameTypePing, nullptr) == ERROR) {
+			SHTTP_LOGE(__FUNCTION__, "closing due to ping error");
+			ws->getConnection()->close();
+			return;
+		}
+		ws->lastPingSent = now;
+	}
+
+	timers.schedule(&ws->pingTimer, ws->pingInterval);
+}
+
 Websocket WebsocketManager::connections[poolSize];
 WebsocketManager::FrameReceivedHandler WebsocketManager::frameReceivedHandler = 0;
 int WebsocketManager::lastConnectionsInUse = 0;
+TimerWheel WebsocketManager::timers;
@@ -47,7 +47,7 @@ Result Websocket::writeFrame(FrameType frameType,const Payload* payload) {
 
 Result Websocket::writeFrame(ServerConnection *conn, FrameType frameType,const Payload* payload)
 {
-	uint8_t header[5] = "";
+	uint8_t header[10] = "";
 	uint8_t *headerPtr = header + 1;
 	header[0] = FlagFIN | frameType;
 	uint32_t totalPayloadSize = 0;
@@ -72,33 +72,51 @@ Result Websocket::writeFrame(ServerConnection *conn, FrameType frameType,const P
 	}
 	else
 	{
-		// for now only allow up to 16bit length
-		return ERROR;
+		//64 bit length, the top 4 bytes are always 0
+		*(headerPtr++) = 127;
+		headerPtr += 4;
+		*(headerPtr++) = (totalPayloadSize >> 24);
+		*(headerPtr++) = (totalPayloadSize >> 16) & 0xFF;
+		*(headerPtr++) = (totalPayloadSize >> 8) & 0xFF;
+		*(headerPtr++) = (totalPayloadSize & 0xFF);
 	}
 
 	auto headerSize = (headerPtr - header);
 
-	Payload top{
-		header,
-		(uint32_t)headerSize,
-		false,
-		payload
-	};
-
 	LOCK_TCPIP_CORE();
 	if( totalPayloadSize + headerSize > conn->availableSendBuffer() ){
 		UNLOCK_TCPIP_CORE();
 		return ERROR;
 	}
 
-	auto current = &top;
-	while ( current != nullptr) {
-		if (!conn->writeData(current->data, current->size,ServerConnection::WriteFlagNoLock | (current->byRef ? ServerConnection::WriteFlagZeroCopy : 0))) {
+	//the header and payload go out in one write, or one per MaxSegments for long payload lists
+	//segments are u16 sized so larger payloads take several
+	static const int MaxSegments = 8;
+	static const uint32_t MaxSegmentSize = UINT16_MAX;
+	Transport::WriteSegment segments[MaxSegments];
+	segments[0] = { header, (u16_t)headerSize, true };
+	int segmentCount = 1;
+	auto current = payload;
+	uint32_t offset = 0;
+	do {
+		while (current != nullptr && segmentCount < MaxSegments) {
+			uint32_t size = current->size - offset;
+			if (size > MaxSegmentSize) {
+				size = MaxSegmentSize;
+			}
+			segments[segmentCount++] = { current->data + offset, (u16_t)size, !current->byRef };
+			offset += size;
+			if (offset == current->size) {
+				current = (Payload*)current->next;
+				offset = 0;
+			}
+		}
+		if (!conn->writeSegments(segments, segmentCount, ServerConnection::WriteFlagNoLock)) {
 			UNLOCK_TCPIP_CORE();
 			return AvailableBufferTooSmall;
 		}
-		current = (Payload*)current->next;
-	}
+		segmentCount = 0;
+	} while (current != nullptr);
 	UNLOCK_TCPIP_CORE();
 	return OK;
 }
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2023 Rhys Bryant
+ *  Author Rhys Bryant
+ *
+ *	This file is part of SimpleHTTP
+ *
+ *   SimpleHTTP is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   any later version.
+ *
+ *   SimpleHTTP is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with SimpleHTTP.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "MockServerConnection.h"
+#include "Websocket.h"
+#include <string>
+using namespace SimpleHTTP;
+using SimpleHTTPTest::MockServerConnection;
+using std::string;
+
+TEST(Websocket, writeFrameLengths) {
+	MockServerConnection conn;
+	string data(200, 'x');
+	Websocket::Payload payload = { (const uint8_t*)data.data(), 100, false, nullptr };
+	ASSERT_EQ(Websocket::writeFrame(&conn, Websocket::FrameTypeText, &payload), OK);
+	ASSERT_EQ(conn.buffer.substr(0, 2), string("\x81\x64", 2));
+	ASSERT_EQ(conn.buffer.size(), 2u + 100);
+
+	conn.buffer.clear();
+	payload.size = 200;
+	ASSERT_EQ(Websocket::writeFrame(&conn, Websocket::FrameTypeBin, &payload), OK);
+	ASSERT_EQ(conn.buffer.substr(0, 4), string("\x82\x7E\x00\xC8", 4));
+	ASSERT_EQ(conn.buffer.size(), 4u + 200);
+}
+
+TEST(Websocket, writeFrameOver64k) {
+	MockServerConnection conn;
+	conn.setAvailableSendBuffer(1024 * 1024);
+	//longer than one u16 segment, in a list with a second payload after it
+	string first(70000, 'a');
+	for (size_t i = 0; i < first.size(); i++) {
+		first[i] = 'a' + i % 26;
+	}
+	string second(10, 'z');
+	Websocket::Payload tail = { (const uint8_t*)second.data(), (uint32_t)second.size(), true, nullptr };
+	Websocket::Payload payload = { (const uint8_t*)first.data(), (uint32_t)first.size(), false, &tail };
+	ASSERT_EQ(Websocket::writeFrame(&conn, Websocket::FrameTypeBin, &payload), OK);
+
+	//127 then a 64 bit length of 70010
+	ASSERT_EQ(conn.buffer.substr(0, 10), string("\x82\x7F\x00\x00\x00\x00\x00\x01\x11\x7A", 10));
+	ASSERT_EQ(conn.buffer.size(), 10 + first.size() + second.size());
+	ASSERT_EQ(conn.buffer.substr(10), first + second);
+
+	//still limited by the send buffer
+	conn.buffer.clear();
+	conn.setAvailableSendBuffer(0xffff);
+	ASSERT_EQ(Websocket::writeFrame(&conn, Websocket::FrameTypeBin, &payload), ERROR);
+	ASSERT_EQ(conn.buffer, "");
+}
@@ -19,24 +19,147 @@
  */
 #include "utility.h"
 #include "string.h"
+#include <ctype.h>
 
 int SimpleHTTP::Utility::toASCII(int value, char* buffer, int base,int size)
 {
-    char bufTmp[10]="";
-    int index = sizeof(bufTmp);
+    if (base < 2 || base > 16) {
+        return 0;
+    }
+    int sign = 0;
+    uint32_t remaining = value;
+    if (value < 0) {
+        if (size < 1) {
+            return 0;
+        }
+        *buffer++ = '-';
+        size--;
+        sign = 1;
+        remaining = -(uint32_t)value;
+    }
 
+    int digits;
+    if (base == DecBase) {
+        digits = formatDecimal(remaining, buffer, size);
+    }
+    else if (base == HexBase) {
+        digits = formatHex(remaining, buffer, size);
+    }
+    else {
+        digits = toASCIIDivide(remaining, buffer, base, size);
+    }
+    return digits == 0 ? 0 : digits + sign;
+}
 
+int SimpleHTTP::Utility::toASCIIDivide(uint32_t remaining, char* buffer, int base, int size)
+{
+    //enough for base 2
+    char bufTmp[32];
+    int index = sizeof(bufTmp);
     do {
-        auto tmp = value % base;
-        value /= base;
-        index--;
-        bufTmp[index] = ASCIILookup[tmp];
+        bufTmp[--index] = ASCIILookup[remaining % base];
+        remaining /= base;
+    } while (remaining != 0);
 
-    } while (value != 0);
-    
     int outSize = sizeof(bufTmp) - index;
+    if (outSize > size) {
+        return 0;
+    }
     memcpy(buffer,bufTmp+index,outSize);
 
     return outSize;
 }
+
+int SimpleHTTP::Utility::formatDecimal(uint32_t value, char* buffer, int size)
+{
+    static const uint32_t powers[] = { 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    int digits = 1;
+    while (digits < 10 && value >= powers[digits - 1]) {
+        digits++;
+    }
+    if (digits > size) {
+        return 0;
+    }
+
+    //from the last digit back
+    char* pos = buffer + digits;
+    while (value >= 100) {
+        int pair = (value % 100) * 2;
+        value /= 100;
+        pos -= 2;
+        pos[0] = DecimalPairs[pair];
+        pos[1] = DecimalPairs[pair + 1];
+    }
+    if (value >= 10) {
+        pos[-2] = DecimalPairs[value * 2];
+        pos[-1] = DecimalPairs[value * 2 + 1];
+    }
+    else {
+        pos[-1] = '0' + value;
+    }
+    return digits;
+}
+
+int SimpleHTTP::Utility::formatHex(uint32_t value, char* buffer, int size)
+{
+    //a nibble per digit, at least one digit for 0
+    int digits = 1;
+    while (digits < 8 && (value >> (digits * 4)) != 0) {
+        digits++;
+    }
+    if (digits > size) {
+        return 0;
+    }
+
+    char* pos = buffer + digits;
+    //a byte (two digits) per step, the first digit may be on its own
+    while (pos - buffer >= 2) {
+        pos -= 2;
+        pos[0] = ASCIILookup[(value >> 4) & 0xF];
+        pos[1] = ASCIILookup[value & 0xF];
+        value >>= 8;
+    }
+    if (pos != buffer) {
+        buffer[0] = ASCIILookup[value & 0xF];
+    }
+    return digits;
+}
+
 const constexpr char SimpleHTTP::Utility::ASCIILookup[];
+const char SimpleHTTP::Utility::DecimalPairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+bool SimpleHTTP::Utility::equalsIgnoreCase(SimpleString str, const char* value)
+{
+    int length = strlen(value);
+    if (str.value == nullptr || str.size != length) {
+        return false;
+    }
+    for (int i = 0; i < length; i++) {
+        if (tolower((unsigned char)str.value[i]) != tolower((unsigned char)value[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SimpleHTTP::Utility::contains(SimpleString str, const char* value)
+{
+    int length = strlen(value);
+    for (int i = 0; i + length <= str.size; i++) {
+        if (memcmp(str.value + i, value, length) == 0) {
+            return true;
+        }
+    }
+    return false;
+}